@@ -1,4 +1,4 @@
-QT       += core gui sql
+QT       += core gui sql concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -8,6 +8,9 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# Счетчики жизненного цикла Contact/PhoneNumber и кнопка "Статистика"
+#DEFINES += PHONEBOOK_LIFETIME_STATS
+
 SOURCES += \
     main.cpp \
     mainwindow.cpp \
@@ -19,6 +22,13 @@ SOURCES += \
     phonewidget.cpp \
     filestorage.cpp \
     databasestorage.cpp \
+    binarystorage.cpp \
+    contacttablemodel.cpp \
+    searchindex.cpp \
+    prefixindex.cpp \
+    phonekernel.cpp \
+    contactimporter.cpp \
+    validation.cpp \
     storagechoicedialog.cpp
 
 HEADERS += \
@@ -28,10 +38,19 @@ HEADERS += \
     contactdialog.h \
     databasemanager.h \
     phonenumber.h \
+    smallvector.h \
+    instrumentation.h \
     phonewidget.h \
     istorage.h \
     filestorage.h \
     databasestorage.h \
+    binarystorage.h \
+    contacttablemodel.h \
+    searchindex.h \
+    prefixindex.h \
+    phonekernel.h \
+    contactimporter.h \
+    validation.h \
     storagechoicedialog.h
 
 #TRANSLATIONS += \
@@ -0,0 +1,905 @@
+#include "binarystorage.h"
+#include <QSaveFile>
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+namespace {
+const char kMagic[4] = {'P', 'B', 'K', 'B'};
+constexpr quint32 kVersion = 1;
+// Журнал сворачивается, когда он больше половины файла, но не раньше 1 МБ
+constexpr qint64 kMinCompactionThreshold = 1024 * 1024;
+
+// Запись журнала: заголовок, затем данные операции (QDataStream)
+enum JournalOp : quint8 {
+    JournalPut = 1,    // контакт целиком
+    JournalDelete = 2  // id
+};
+
+struct JournalHeader {
+    quint32 size;      // длина данных
+    quint16 checksum;  // qChecksum данных
+    quint8 op;
+    quint8 reserved;
+};
+
+std::string_view bytesView(const QByteArray& bytes)
+{
+    return std::string_view(bytes.constData(), size_t(bytes.size()));
+}
+
+QByteArray journalEntry(JournalOp op, const QByteArray& payload)
+{
+    JournalHeader header{quint32(payload.size()),
+                         qChecksum(payload.constData(), uint(payload.size())),
+                         op, 0};
+    QByteArray entry(reinterpret_cast<const char*>(&header), sizeof(header));
+    entry.append(payload);
+    return entry;
+}
+}
+
+BinaryStorage::BinaryStorage(const QString& filePath)
+    : m_filePath(filePath)
+    , m_journalPath(filePath + ".journal")
+    , m_nextId(1)
+    , m_loaded(false)
+    , m_dirty(false)
+    , m_data(nullptr)
+    , m_header(nullptr)
+    , m_records(nullptr)
+    , m_phones(nullptr)
+    , m_arena(nullptr)
+    , m_contactCount(0)
+    , m_journalSize(0)
+    , m_indexBuilt(false)
+    , m_lastNamesBuilt(false)
+{
+    static_assert(sizeof(Header) == 32, "Header must be 32 bytes");
+    static_assert(sizeof(ContactRecord) == 60, "ContactRecord must be 60 bytes");
+    static_assert(sizeof(PhoneRecord) == 16, "PhoneRecord must be 16 bytes");
+    static_assert(sizeof(JournalHeader) == 8, "JournalHeader must be 8 bytes");
+
+    // Изменения, не попавшие в файл до закрытия, лежат в журнале
+    m_loaded = mapFile() && replayJournal();
+}
+
+BinaryStorage::~BinaryStorage()
+{
+    // При неудаче журнал остается и будет накатан при следующем открытии
+    flush();
+    m_journal.close();
+    unmapFile();
+}
+
+bool BinaryStorage::mapFile()
+{
+    m_file.setFileName(m_filePath);
+    if (!m_file.exists()) {
+        return true; // Файл еще не создан - это нормально
+    }
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_lastError = "Не удалось открыть файл для чтения";
+        return false;
+    }
+
+    qint64 size = m_file.size();
+    if (size < static_cast<qint64>(sizeof(Header))) {
+        m_lastError = "Некорректный формат файла";
+        m_file.close();
+        return false;
+    }
+
+    m_data = m_file.map(0, size);
+    if (!m_data) {
+        m_lastError = "Не удалось отобразить файл в память";
+        m_file.close();
+        return false;
+    }
+
+    m_header = reinterpret_cast<const Header*>(m_data);
+    quint64 expected = sizeof(Header)
+        + quint64(m_header->contactCount) * sizeof(ContactRecord)
+        + quint64(m_header->phoneCount) * sizeof(PhoneRecord)
+        + m_header->arenaSize;
+
+    if (std::memcmp(m_header->magic, kMagic, sizeof(kMagic)) != 0 ||
+        m_header->version != kVersion ||
+        expected != quint64(size)) {
+        m_lastError = "Некорректный формат файла";
+        unmapFile();
+        return false;
+    }
+
+    m_contactCount = m_header->contactCount;
+    m_records = reinterpret_cast<const ContactRecord*>(m_data + sizeof(Header));
+    m_phones = reinterpret_cast<const PhoneRecord*>(m_records + m_header->contactCount);
+    m_arena = reinterpret_cast<const char*>(m_phones + m_header->phoneCount);
+    m_nextId = qMax(1, m_header->nextId);
+    return true;
+}
+
+void BinaryStorage::unmapFile()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar*>(m_data));
+    }
+    m_file.close();
+
+    m_data = nullptr;
+    m_header = nullptr;
+    m_records = nullptr;
+    m_phones = nullptr;
+    m_arena = nullptr;
+    m_contactCount = 0;
+    m_rows.clear();
+}
+
+bool BinaryStorage::checkLoaded()
+{
+    // Если файл не удалось прочитать, не даем затереть его при записи
+    if (!m_loaded) {
+        m_lastError = "Файл контактов не загружен";
+        return false;
+    }
+    return true;
+}
+
+void BinaryStorage::buildRowIndex() const
+{
+    if (!m_rows.empty() || m_contactCount == 0) {
+        return;
+    }
+    m_rows.reserve(m_contactCount);
+    for (quint32 row = 0; row < m_contactCount; ++row) {
+        m_rows[m_records[row].id] = row;
+    }
+}
+
+bool BinaryStorage::contains(int id) const
+{
+    if (m_changed.count(id)) {
+        return true;
+    }
+    if (m_removed.count(id)) {
+        return false;
+    }
+    buildRowIndex();
+    return m_rows.count(id) != 0;
+}
+
+bool BinaryStorage::isShadowed(const ContactRecord& record) const
+{
+    // Строка файла скрыта, если контакт удален или перезаписан в памяти
+    return (!m_removed.empty() && m_removed.count(record.id)) ||
+           (!m_changed.empty() && m_changed.count(record.id));
+}
+
+QString BinaryStorage::fieldString(const StrRef& ref) const
+{
+    if (quint64(ref.offset) + ref.length > m_header->arenaSize) {
+        return QString();
+    }
+    return QString::fromUtf8(m_arena + ref.offset, int(ref.length));
+}
+
+std::string_view BinaryStorage::fieldView(const StrRef& ref) const
+{
+    if (quint64(ref.offset) + ref.length > m_header->arenaSize) {
+        return std::string_view();
+    }
+    return std::string_view(m_arena + ref.offset, ref.length);
+}
+
+void BinaryStorage::decodeInto(const ContactRecord& record, Contact& contact) const
+{
+    // Строки файла проверялись при записи - копируем их без валидации
+    contact = Contact::fromStorage(record.id,
+                                   fieldView(record.fields[LastName]),
+                                   fieldView(record.fields[FirstName]),
+                                   fieldView(record.fields[MiddleName]),
+                                   fieldView(record.fields[BirthDate]),
+                                   fieldView(record.fields[Address]),
+                                   fieldView(record.fields[Email]),
+                                   contact.get_allocator());
+
+    if (quint64(record.firstPhone) + record.phoneCount <= m_header->phoneCount) {
+        for (quint32 i = 0; i < record.phoneCount; ++i) {
+            const PhoneRecord& phone = m_phones[record.firstPhone + i];
+            contact.addStoredPhoneNumber(fieldView(phone.number), fieldView(phone.type));
+        }
+    }
+}
+
+Contact BinaryStorage::decodeContact(const ContactRecord& record) const
+{
+    Contact contact;
+    decodeInto(record, contact);
+    return contact;
+}
+
+std::string BinaryStorage::recordSearchKey(const ContactRecord& record) const
+{
+    // Ключ собирается прямо из отображения, без промежуточного Contact и копий строк
+    // Диапазон телефонов проверяется так же, как в decodeInto: поврежденная
+    // запись не должна уводить чтение за конец таблицы
+    std::vector<std::string_view> phones;
+    if (quint64(record.firstPhone) + record.phoneCount <= m_header->phoneCount) {
+        phones.reserve(record.phoneCount);
+        for (quint32 i = 0; i < record.phoneCount; ++i) {
+            phones.push_back(fieldView(m_phones[record.firstPhone + i].number));
+        }
+    }
+    return SearchIndex::searchKey(fieldView(record.fields[LastName]),
+                                  fieldView(record.fields[FirstName]),
+                                  fieldView(record.fields[MiddleName]),
+                                  fieldView(record.fields[Email]),
+                                  fieldView(record.fields[Address]),
+                                  phones);
+}
+
+void BinaryStorage::buildSearchIndex() const
+{
+    if (m_indexBuilt) {
+        return;
+    }
+    for (quint32 row = 0; row < m_contactCount; ++row) {
+        if (!isShadowed(m_records[row])) {
+            m_index.insert(m_records[row].id, recordSearchKey(m_records[row]));
+        }
+    }
+    for (const auto& entry : m_changed) {
+        m_index.insert(entry.first, SearchIndex::searchKey(entry.second));
+    }
+    m_indexBuilt = true;
+}
+
+void BinaryStorage::buildLastNameIndex() const
+{
+    if (m_lastNamesBuilt) {
+        return;
+    }
+    for (quint32 row = 0; row < m_contactCount; ++row) {
+        if (!isShadowed(m_records[row])) {
+            m_lastNames.insert(m_records[row].id, fieldView(m_records[row].fields[LastName]));
+        }
+    }
+    for (const auto& entry : m_changed) {
+        m_lastNames.insert(entry.first, entry.second.getLastName());
+    }
+    m_lastNamesBuilt = true;
+}
+
+void BinaryStorage::putContact(Contact&& contact)
+{
+    int id = contact.getId();
+    auto existing = m_changed.find(id);
+    if (existing != m_changed.end()) {
+        m_changedOrder.erase({std::string(existing->second.getLastName()), id});
+    }
+    m_changedOrder.emplace(std::string(contact.getLastName()), id);
+    if (m_indexBuilt) {
+        m_index.insert(id, SearchIndex::searchKey(contact));
+    }
+    if (m_lastNamesBuilt) {
+        m_lastNames.insert(id, contact.getLastName());
+    }
+    m_changed.insert_or_assign(id, std::move(contact));
+    m_dirty = true;
+}
+
+void BinaryStorage::removeContact(int id)
+{
+    auto existing = m_changed.find(id);
+    if (existing != m_changed.end()) {
+        m_changedOrder.erase({std::string(existing->second.getLastName()), id});
+        m_changed.erase(existing);
+    }
+    m_index.remove(id);
+    m_lastNames.remove(id);
+    buildRowIndex();
+    if (m_rows.count(id)) {
+        m_removed.insert(id);
+    }
+    m_dirty = true;
+}
+
+bool BinaryStorage::addContact(const Contact& contact)
+{
+    if (!checkLoaded()) {
+        return false;
+    }
+
+    Contact newContact = contact;
+    newContact.setId(m_nextId);
+    if (!appendToJournal(journalPut(newContact))) {
+        return false;
+    }
+
+    ++m_nextId;
+    putContact(std::move(newContact));
+    maybeCompact();
+    return true;
+}
+
+bool BinaryStorage::updateContact(int id, const Contact& contact)
+{
+    if (!checkLoaded()) {
+        return false;
+    }
+
+    if (!contains(id)) {
+        m_lastError = "Контакт не найден";
+        return false;
+    }
+
+    Contact updated = contact;
+    updated.setId(id);
+    if (!appendToJournal(journalPut(updated))) {
+        return false;
+    }
+
+    putContact(std::move(updated));
+    maybeCompact();
+    return true;
+}
+
+bool BinaryStorage::deleteContact(int id)
+{
+    if (!checkLoaded()) {
+        return false;
+    }
+
+    if (!contains(id)) {
+        m_lastError = "Контакт не найден";
+        return false;
+    }
+
+    if (!appendToJournal(journalDelete(id))) {
+        return false;
+    }
+
+    removeContact(id);
+    maybeCompact();
+    return true;
+}
+
+std::vector<bool> BinaryStorage::addContacts(std::vector<Contact>& contacts)
+{
+    std::vector<bool> results(contacts.size(), false);
+    if (!checkLoaded() || contacts.empty()) {
+        return results;
+    }
+
+    // Весь пакет уходит в журнал одной записью на диск
+    QByteArray entries;
+    int nextId = m_nextId;
+    for (auto& contact : contacts) {
+        contact.setId(nextId++);
+        entries.append(journalPut(contact));
+    }
+    if (!appendToJournal(entries)) {
+        for (auto& contact : contacts) {
+            contact.setId(-1);
+        }
+        return results;
+    }
+
+    m_nextId = nextId;
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        putContact(Contact(contacts[i]));
+        results[i] = true;
+    }
+    maybeCompact();
+    return results;
+}
+
+std::vector<bool> BinaryStorage::updateContacts(const std::vector<Contact>& contacts)
+{
+    std::vector<bool> results(contacts.size(), false);
+    if (!checkLoaded()) {
+        return results;
+    }
+
+    QByteArray entries;
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        if (!contains(contacts[i].getId())) {
+            m_lastError = "Контакт не найден";
+            continue;
+        }
+        entries.append(journalPut(contacts[i]));
+        results[i] = true;
+    }
+    if (entries.isEmpty()) {
+        return results;
+    }
+    if (!appendToJournal(entries)) {
+        return std::vector<bool>(contacts.size(), false);
+    }
+
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        if (results[i]) {
+            putContact(Contact(contacts[i]));
+        }
+    }
+    maybeCompact();
+    return results;
+}
+
+std::vector<bool> BinaryStorage::deleteContacts(const std::vector<int>& ids)
+{
+    std::vector<bool> results(ids.size(), false);
+    if (!checkLoaded()) {
+        return results;
+    }
+
+    QByteArray entries;
+    std::unordered_set<int> removed; // повтор id в одном пакете - ошибка
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (!contains(ids[i]) || !removed.insert(ids[i]).second) {
+            m_lastError = "Контакт не найден";
+            continue;
+        }
+        entries.append(journalDelete(ids[i]));
+        results[i] = true;
+    }
+    if (entries.isEmpty()) {
+        return results;
+    }
+    if (!appendToJournal(entries)) {
+        return std::vector<bool>(ids.size(), false);
+    }
+
+    for (int id : removed) {
+        removeContact(id);
+    }
+    maybeCompact();
+    return results;
+}
+
+void BinaryStorage::collectContacts(std::pmr::vector<Contact>& contacts) const
+{
+    contacts.reserve(m_contactCount + m_changed.size());
+    forEachContact([&contacts](const Contact& contact) {
+        contacts.push_back(contact);
+        return true;
+    });
+}
+
+bool BinaryStorage::getContact(int id, Contact& contact) const
+{
+    auto changed = m_changed.find(id);
+    if (changed != m_changed.end()) {
+        contact = changed->second;
+        return true;
+    }
+    if (m_removed.count(id)) {
+        return false;
+    }
+
+    buildRowIndex();
+    auto row = m_rows.find(id);
+    if (row == m_rows.end()) {
+        return false;
+    }
+    decodeInto(m_records[row->second], contact);
+    return true;
+}
+
+std::vector<Contact> BinaryStorage::getAllContacts() const
+{
+    std::pmr::vector<Contact> contacts;
+    collectContacts(contacts);
+    // Контакты уже в ресурсе по умолчанию - перемещение строк не копирует
+    return std::vector<Contact>(std::make_move_iterator(contacts.begin()),
+                                std::make_move_iterator(contacts.end()));
+}
+
+std::vector<Contact> BinaryStorage::findContacts(const QString& query) const
+{
+    std::vector<Contact> result;
+    forEachMatch(query, [&result](const Contact& contact) {
+        result.push_back(contact);
+        return true;
+    });
+    return result;
+}
+
+bool BinaryStorage::forEachContact(const ContactVisitor& visitor) const
+{
+    // Все строки файла разбираются в один и тот же Contact
+    Contact contact;
+    for (quint32 row = 0; row < m_contactCount; ++row) {
+        if (isShadowed(m_records[row])) {
+            continue;
+        }
+        decodeInto(m_records[row], contact);
+        if (!visitor(contact)) {
+            return false;
+        }
+    }
+
+    for (const auto& entry : m_changed) {
+        if (!visitor(entry.second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BinaryStorage::forEachMatch(const QString& query, const ContactVisitor& visitor) const
+{
+    if (query.isEmpty()) {
+        return forEachContact(visitor);
+    }
+
+    buildSearchIndex();
+    buildRowIndex();
+
+    Contact contact;
+    for (int id : m_index.find(SearchIndex::fold(query))) {
+        auto changed = m_changed.find(id);
+        if (changed != m_changed.end()) {
+            if (!visitor(changed->second)) {
+                return false;
+            }
+            continue;
+        }
+        auto row = m_rows.find(id);
+        if (row == m_rows.end()) {
+            continue;
+        }
+        decodeInto(m_records[row->second], contact);
+        if (!visitor(contact)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> BinaryStorage::completeLastName(const QString& prefix, int limit) const
+{
+    buildLastNameIndex();
+    return m_lastNames.complete(SearchIndex::fold(prefix), limit);
+}
+
+std::vector<Contact> BinaryStorage::findByLastNamePrefix(const QString& prefix, int limit) const
+{
+    buildLastNameIndex();
+    std::vector<Contact> result;
+    Contact contact;
+    for (int id : m_lastNames.range(SearchIndex::fold(prefix), limit)) {
+        if (getContact(id, contact)) {
+            result.push_back(contact);
+        }
+    }
+    return result;
+}
+
+bool BinaryStorage::matchesQuery(const Contact& contact, const QString& query) const
+{
+    return query.isEmpty() ||
+           SearchIndex::searchKey(contact).find(SearchIndex::fold(query)) != std::string::npos;
+}
+
+std::vector<Contact> BinaryStorage::getContactsPage(const ContactPageKey& after, int limit) const
+{
+    std::vector<Contact> page;
+    if (limit <= 0) {
+        return page;
+    }
+
+    // Таблица в файле уже упорядочена по (фамилия, id): ищем начало двоичным поиском
+    const ContactRecord* row = std::upper_bound(
+        m_records, m_records + m_contactCount, after,
+        [this](const ContactPageKey& key, const ContactRecord& record) {
+            int cmp = std::string_view(key.lastName).compare(fieldView(record.fields[LastName]));
+            return cmp < 0 || (cmp == 0 && key.id < record.id);
+        });
+    const ContactRecord* end = m_records + m_contactCount;
+
+    // Изменения в памяти сливаем с таблицей в том же порядке
+    auto changed = m_changedOrder.upper_bound({after.lastName, after.id});
+
+    while (int(page.size()) < limit) {
+        while (row != end && isShadowed(*row)) {
+            ++row;
+        }
+        bool haveRow = row != end;
+        bool haveChanged = changed != m_changedOrder.end();
+        if (!haveRow && !haveChanged) {
+            break;
+        }
+
+        bool takeRow = haveRow;
+        if (haveRow && haveChanged) {
+            int cmp = fieldView(row->fields[LastName]).compare(changed->first);
+            takeRow = cmp < 0 || (cmp == 0 && row->id < changed->second);
+        }
+
+        if (takeRow) {
+            page.push_back(decodeContact(*row));
+            ++row;
+        } else {
+            page.push_back(m_changed.at(changed->second));
+            ++changed;
+        }
+    }
+    return page;
+}
+
+QString BinaryStorage::getLastError() const
+{
+    return m_lastError;
+}
+
+QByteArray BinaryStorage::journalPut(const Contact& contact)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    auto writeString = [&out](std::string_view value) {
+        out << QByteArray::fromRawData(value.data(), int(value.size()));
+    };
+
+    out << qint32(contact.getId());
+    writeString(contact.getLastName());
+    writeString(contact.getFirstName());
+    writeString(contact.getMiddleName());
+    writeString(contact.getBirthDate());
+    writeString(contact.getAddress());
+    writeString(contact.getEmail());
+    out << quint32(contact.getPhoneNumbers().size());
+    for (const auto& phone : contact.getPhoneNumbers()) {
+        writeString(phone.getNumber());
+        writeString(phone.getType());
+    }
+    return journalEntry(JournalPut, payload);
+}
+
+QByteArray BinaryStorage::journalDelete(int id)
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out << qint32(id);
+    return journalEntry(JournalDelete, payload);
+}
+
+bool BinaryStorage::applyJournalEntry(quint8 op, const QByteArray& payload)
+{
+    QDataStream in(payload);
+    qint32 id = 0;
+    in >> id;
+    if (op == JournalDelete) {
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+        removeContact(id);
+        return true;
+    }
+    if (op != JournalPut) {
+        return false;
+    }
+
+    // Поля в порядке Field
+    QByteArray fields[FieldCount];
+    for (auto& field : fields) {
+        in >> field;
+    }
+    quint32 phoneCount = 0;
+    in >> phoneCount;
+    if (in.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    Contact contact = Contact::fromStorage(id,
+                                           bytesView(fields[LastName]),
+                                           bytesView(fields[FirstName]),
+                                           bytesView(fields[MiddleName]),
+                                           bytesView(fields[BirthDate]),
+                                           bytesView(fields[Address]),
+                                           bytesView(fields[Email]));
+    for (quint32 i = 0; i < phoneCount; ++i) {
+        QByteArray number;
+        QByteArray type;
+        in >> number >> type;
+        if (in.status() != QDataStream::Ok) {
+            return false;
+        }
+        contact.addStoredPhoneNumber(bytesView(number), bytesView(type));
+    }
+
+    m_nextId = qMax(m_nextId, id + 1);
+    putContact(std::move(contact));
+    return true;
+}
+
+bool BinaryStorage::replayJournal()
+{
+    QFile file(m_journalPath);
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadWrite)) {
+        m_lastError = "Не удалось открыть журнал для чтения";
+        return false;
+    }
+
+    // Записи содержат контакт целиком, поэтому повторный накат
+    // (сбой между записью файла и удалением журнала) безопасен
+    QByteArray data = file.readAll();
+    qint64 validSize = 0;
+    while (validSize + qint64(sizeof(JournalHeader)) <= data.size()) {
+        JournalHeader header;
+        std::memcpy(&header, data.constData() + validSize, sizeof(header));
+        qint64 end = validSize + qint64(sizeof(header)) + header.size;
+        if (end > data.size()) {
+            break;
+        }
+        const char* payload = data.constData() + validSize + sizeof(header);
+        if (qChecksum(payload, header.size) != header.checksum ||
+            !applyJournalEntry(header.op, QByteArray::fromRawData(payload, int(header.size)))) {
+            break;
+        }
+        validSize = end;
+    }
+
+    if (validSize < data.size()) {
+        // Недописанная запись после сбоя: отрезаем хвост, чтобы
+        // новые записи не оказались за ним
+        qDebug() << "Journal truncated at offset" << validSize << "in" << m_journalPath;
+        file.resize(validSize);
+    }
+    m_journalSize = validSize;
+    return true;
+}
+
+bool BinaryStorage::appendToJournal(const QByteArray& entries)
+{
+    if (!m_journal.isOpen()) {
+        m_journal.setFileName(m_journalPath);
+        if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            m_lastError = "Не удалось открыть журнал для записи";
+            return false;
+        }
+    }
+
+    if (m_journal.write(entries) != entries.size() || !m_journal.flush()) {
+        m_lastError = "Не удалось записать журнал";
+        return false;
+    }
+    m_journalSize += entries.size();
+    return true;
+}
+
+void BinaryStorage::maybeCompact()
+{
+    qint64 fileSize = m_header ? qint64(m_file.size()) : 0;
+    if (m_journalSize > qMax(kMinCompactionThreshold, fileSize / 2)) {
+        flush();
+    }
+}
+
+bool BinaryStorage::flush()
+{
+    if (!m_dirty) {
+        return true;
+    }
+
+    // Временная копия книги живет только до записи: все ее строки
+    // берутся из одной арены и освобождаются разом
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<Contact> contacts(&arena);
+    collectContacts(contacts);
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        m_lastError = "Не удалось открыть файл для записи";
+        return false;
+    }
+
+    if (!writeContacts(file, contacts, m_nextId)) {
+        m_lastError = "Не удалось записать файл";
+        file.cancelWriting();
+        return false;
+    }
+
+    // Отображенный файл нельзя подменить (Windows), поэтому снимаем отображение
+    unmapFile();
+    bool committed = file.commit();
+    if (!committed) {
+        m_lastError = "Не удалось записать файл";
+    } else {
+        m_changed.clear();
+        m_changedOrder.clear();
+        m_removed.clear();
+        m_dirty = false;
+        // Все из журнала уже в файле
+        m_journal.close();
+        QFile::remove(m_journalPath);
+        m_journalSize = 0;
+    }
+
+    if (!mapFile()) {
+        m_loaded = false;
+        return false;
+    }
+    return committed;
+}
+
+bool BinaryStorage::writeContacts(QIODevice& device, std::pmr::vector<Contact>& contacts, int nextId)
+{
+    // Таблица упорядочена по (фамилия, id)
+    std::sort(contacts.begin(), contacts.end(), [](const Contact& a, const Contact& b) {
+        if (a.getLastName() != b.getLastName()) {
+            return a.getLastName() < b.getLastName();
+        }
+        return a.getId() < b.getId();
+    });
+
+    QByteArray arena;
+    QHash<QByteArray, StrRef> interned; // повторяющиеся типы телефонов храним один раз
+
+    auto appendString = [&arena](std::string_view value) {
+        StrRef ref{quint32(arena.size()), quint32(value.size())};
+        arena.append(value.data(), int(value.size()));
+        return ref;
+    };
+    auto appendInterned = [&](std::string_view value) {
+        QByteArray key(value.data(), int(value.size()));
+        auto it = interned.constFind(key);
+        if (it != interned.constEnd()) {
+            return it.value();
+        }
+        StrRef ref = appendString(value);
+        interned.insert(key, ref);
+        return ref;
+    };
+
+    std::vector<ContactRecord> records;
+    std::vector<PhoneRecord> phones;
+    records.reserve(contacts.size());
+
+    for (const auto& contact : contacts) {
+        ContactRecord record;
+        record.id = contact.getId();
+        record.firstPhone = quint32(phones.size());
+        record.phoneCount = quint32(contact.getPhoneNumbers().size());
+        record.fields[LastName] = appendString(contact.getLastName());
+        record.fields[FirstName] = appendString(contact.getFirstName());
+        record.fields[MiddleName] = appendString(contact.getMiddleName());
+        record.fields[BirthDate] = appendString(contact.getBirthDate());
+        record.fields[Address] = appendString(contact.getAddress());
+        record.fields[Email] = appendString(contact.getEmail());
+        records.push_back(record);
+
+        for (const auto& phone : contact.getPhoneNumbers()) {
+            PhoneRecord phoneRecord;
+            phoneRecord.number = appendString(phone.getNumber());
+            phoneRecord.type = appendInterned(phone.getType());
+            phones.push_back(phoneRecord);
+        }
+    }
+
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.contactCount = quint32(records.size());
+    header.phoneCount = quint32(phones.size());
+    header.nextId = nextId;
+    header.reserved = 0;
+    header.arenaSize = quint64(arena.size());
+
+    auto write = [&device](const void* data, qint64 size) {
+        return size == 0 || device.write(static_cast<const char*>(data), size) == size;
+    };
+
+    return write(&header, sizeof(header)) &&
+           write(records.data(), qint64(records.size() * sizeof(ContactRecord))) &&
+           write(phones.data(), qint64(phones.size() * sizeof(PhoneRecord))) &&
+           write(arena.constData(), arena.size());
+}
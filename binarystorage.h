@@ -0,0 +1,146 @@
+#pragma once
+#include "istorage.h"
+#include "searchindex.h"
+#include "prefixindex.h"
+#include <QFile>
+#include <memory_resource>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+// Хранилище в компактном двоичном файле.
+// Файл отображается в память через QFile::map, поэтому при открытии ничего
+// не разбирается: строки читаются прямо из отображения по мере надобности.
+// Изменения копятся в памяти поверх отображения, а каждая операция сразу
+// дописывается в журнал phonebook.pbk.journal. flush() переписывает файл
+// целиком и очищает журнал; он вызывается при закрытии и когда журнал
+// вырастает больше половины файла. При открытии журнал накатывается заново.
+//
+// Формат (little-endian):
+//   Header                          - заголовок, 32 байта
+//   ContactRecord[contactCount]     - таблица контактов, по (фамилия, id)
+//   PhoneRecord[phoneCount]         - таблица телефонов
+//   char[arenaSize]                 - строки в UTF-8 без завершающих нулей
+class BinaryStorage : public IStorage {
+public:
+    explicit BinaryStorage(const QString& filePath);
+    ~BinaryStorage() override;
+
+    bool addContact(const Contact& contact) override;
+    bool updateContact(int id, const Contact& contact) override;
+    bool deleteContact(int id) override;
+    std::vector<bool> addContacts(std::vector<Contact>& contacts) override;
+    std::vector<bool> updateContacts(const std::vector<Contact>& contacts) override;
+    std::vector<bool> deleteContacts(const std::vector<int>& ids) override;
+    bool getContact(int id, Contact& contact) const override;
+    std::vector<Contact> getAllContacts() const override;
+    std::vector<Contact> findContacts(const QString& query) const override;
+    std::vector<Contact> getContactsPage(const ContactPageKey& after, int limit) const override;
+    bool forEachContact(const ContactVisitor& visitor) const override;
+    bool forEachMatch(const QString& query, const ContactVisitor& visitor) const override;
+    std::vector<std::string> completeLastName(const QString& prefix, int limit) const override;
+    std::vector<Contact> findByLastNamePrefix(const QString& prefix, int limit) const override;
+    bool matchesQuery(const Contact& contact, const QString& query) const override;
+    QString getLastError() const override;
+
+    // Записывает накопленные изменения в файл (если они есть) и очищает журнал
+    bool flush();
+    // Приблизительный объем триграммного индекса в байтах; индекс строится
+    // при первом поиске, до этого - 0
+    size_t searchIndexMemoryUsage() const { return m_indexBuilt ? m_index.memoryUsage() : 0; }
+
+private:
+    struct StrRef {
+        quint32 offset;
+        quint32 length;
+    };
+
+    enum Field {
+        LastName,
+        FirstName,
+        MiddleName,
+        BirthDate,
+        Address,
+        Email,
+        FieldCount
+    };
+
+    struct Header {
+        char magic[4];
+        quint32 version;
+        quint32 contactCount;
+        quint32 phoneCount;
+        qint32 nextId;
+        quint32 reserved;
+        quint64 arenaSize;
+    };
+
+    struct ContactRecord {
+        qint32 id;
+        quint32 firstPhone;
+        quint32 phoneCount;
+        StrRef fields[FieldCount];
+    };
+
+    struct PhoneRecord {
+        StrRef number;
+        StrRef type;
+    };
+
+    QString m_filePath;
+    QString m_journalPath;
+    QString m_lastError;
+    int m_nextId;
+    bool m_loaded;
+    bool m_dirty;
+
+    // Отображение файла
+    QFile m_file;
+    const uchar* m_data;
+    const Header* m_header;
+    const ContactRecord* m_records;
+    const PhoneRecord* m_phones;
+    const char* m_arena;
+    quint32 m_contactCount;
+
+    QFile m_journal;
+    qint64 m_journalSize;
+
+    // Изменения поверх отображения
+    std::unordered_map<int, Contact> m_changed;  // добавленные и измененные
+    std::set<std::pair<std::string, int>> m_changedOrder; // (фамилия, id) из m_changed для постраничной выборки
+    std::unordered_set<int> m_removed;           // удаленные из файла id
+    mutable std::unordered_map<int, quint32> m_rows; // id -> строка таблицы, строится лениво
+    // Триграммный индекс строится при первом поиске, чтобы не разбирать файл при открытии
+    mutable SearchIndex m_index;
+    mutable bool m_indexBuilt;
+    mutable PrefixIndex m_lastNames;   // фамилии для автодополнения, тоже строится лениво
+    mutable bool m_lastNamesBuilt;
+
+    bool mapFile();
+    void unmapFile();
+    bool checkLoaded();
+    // Запись изменения поверх отображения вместе с индексами
+    void putContact(Contact&& contact);
+    void removeContact(int id);
+    bool contains(int id) const;
+    bool isShadowed(const ContactRecord& record) const;
+    void buildRowIndex() const;
+    QString fieldString(const StrRef& ref) const;
+    std::string_view fieldView(const StrRef& ref) const;
+    void decodeInto(const ContactRecord& record, Contact& contact) const;
+    Contact decodeContact(const ContactRecord& record) const;
+    std::string recordSearchKey(const ContactRecord& record) const;
+    void buildSearchIndex() const;
+    void buildLastNameIndex() const;
+    // Собирает все контакты в ресурсе списка contacts
+    void collectContacts(std::pmr::vector<Contact>& contacts) const;
+    static QByteArray journalPut(const Contact& contact);
+    static QByteArray journalDelete(int id);
+    bool applyJournalEntry(quint8 op, const QByteArray& payload);
+    bool replayJournal();
+    bool appendToJournal(const QByteArray& entries);
+    void maybeCompact();
+    static bool writeContacts(QIODevice& device, std::pmr::vector<Contact>& contacts, int nextId);
+};
\ No newline at end of file
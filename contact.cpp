@@ -1,75 +1,73 @@
 #include "contact.h"
-#include <regex>
+#include "validation.h"
 #include <QDate>
 
-bool Contact::validateName(const std::string& name) {
-    if (name.empty()) return false;
-    
-    // Регулярное выражение для проверки имени:
-    // ^ - начало строки
-    // [А-ЯA-Z] - первая буква должна быть заглавной (русской или английской)
-    // [а-яА-Яa-zA-Z0-9\s-]* - далее могут быть буквы, цифры, пробелы и дефис
-    // [^-\s] - не должно заканчиваться на дефис или пробел
-    // $ - конец строки
-    static const QRegExp nameRegex("^[А-ЯA-Z][а-яА-Яa-zA-Z0-9\\s-]*[^-\\s]$");
-    
-    QString qName = QString::fromStdString(name.c_str()).trimmed();
-    return nameRegex.exactMatch(qName);
+bool Contact::validateName(std::string_view name) {
+    // Первая буква заглавная (русская или английская), дальше буквы, цифры,
+    // пробелы и дефис; не заканчивается на дефис или пробел
+    return Validation::isName(name);
 }
 
-bool Contact::validateEmail(const std::string& email) {
-    if (email.empty()) return true; // Email может быть пустым
-    
-    // Регулярное выражение для email
-    static const QRegExp emailRegex(
-        "^[a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\\.[a-zA-Z]{2,}$"
-    );
-    
-    QString qEmail = QString::fromStdString(email).trimmed();
-    return emailRegex.exactMatch(qEmail);
+bool Contact::validateEmail(std::string_view email) {
+    return Validation::isEmail(email); // Email может быть пустым
 }
 
-bool Contact::validateDate(const std::string& date) {
+bool Contact::validateDate(std::string_view date) {
     if (date.empty()) return true;
     
-    QDate qdate = QDate::fromString(QString::fromStdString(date), "yyyy-MM-dd");
+    QDate qdate = QDate::fromString(toQString(date), "yyyy-MM-dd");
     return qdate.isValid() && qdate <= QDate::currentDate();
 }
 
-bool Contact::setFirstName(const std::string& name) {
+bool Contact::setFirstName(std::string_view name) {
     if (!validateName(name)) return false;
     firstName = name;
     return true;
 }
 
-bool Contact::setLastName(const std::string& name) {
+bool Contact::setLastName(std::string_view name) {
     if (!validateName(name)) return false;
     lastName = name;
     return true;
 }
 
-bool Contact::setMiddleName(const std::string& name) {
+bool Contact::setMiddleName(std::string_view name) {
     middleName = name;
     return true;
 }
 
-bool Contact::setBirthDate(const std::string& date) {
+bool Contact::setBirthDate(std::string_view date) {
     birthDate = date;
     return true;
 }
 
-bool Contact::setEmail(const std::string& newEmail) {
+bool Contact::setEmail(std::string_view newEmail) {
     if (!validateEmail(newEmail)) return false;
     email = newEmail;
     return true;
 }
 
+Contact Contact::fromStorage(int id, std::string_view lastName, std::string_view firstName,
+                             std::string_view middleName, std::string_view birthDate,
+                             std::string_view address, std::string_view email,
+                             const allocator_type& alloc) {
+    Contact contact(alloc);
+    contact.id = id;
+    contact.lastName = lastName;
+    contact.firstName = firstName;
+    contact.middleName = middleName;
+    contact.birthDate = birthDate;
+    contact.address = address;
+    contact.email = email;
+    return contact;
+}
+
 void Contact::addPhoneNumber(const PhoneNumber& phone) {
     if (phone.isValid()) {
         phoneNumbers.push_back(phone);
     }
 }
 
-void Contact::setAddress(const std::string& newAddress) {
+void Contact::setAddress(std::string_view newAddress) {
     address = newAddress;
 }
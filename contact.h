@@ -1,58 +1,83 @@
 #pragma once
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <QRegExp>
 #include <QDate>
-#include <QDebug>
 #include "phonenumber.h"
+#include "smallvector.h"
+#include "instrumentation.h"
 
+// Contact поддерживает std::pmr: строки и список телефонов берут память
+// из ресурса, переданного при конструировании. Так целый набор контактов
+// можно разместить в одной арене (std::pmr::monotonic_buffer_resource)
+// и освободить разом. Копия без явного аллокатора, как и у pmr-строк,
+// уходит в ресурс по умолчанию и от арены не зависит.
 class Contact {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+    // Почти у всех контактов от одного до трех телефонов - они хранятся
+    // прямо в объекте, без отдельного выделения памяти
+    using PhoneList = SmallVector<PhoneNumber, 3, std::pmr::polymorphic_allocator<PhoneNumber>>;
+
 private:
     int id;
-    std::string firstName;
-    std::string lastName;
-    std::string middleName;
-    std::string birthDate;
-    std::string email;
-    std::string address;
-    std::vector<PhoneNumber> phoneNumbers;
+    std::pmr::string firstName;
+    std::pmr::string lastName;
+    std::pmr::string middleName;
+    std::pmr::string birthDate;
+    std::pmr::string email;
+    std::pmr::string address;
+    PhoneList phoneNumbers;
     
-    // Счетчики для анализа операций
-    inline static int constructorCount = 0;  // Конструктор по умолчанию
-    inline static int copyCount = 0;         // Копирование
-    inline static int moveCount = 0;         // Перемещение
-    inline static int deleteCount = 0;       // Удаление
-    inline static int assignCount = 0;       // Присваивание
-    inline static int moveAssignCount = 0;   // Перемещающее присваивание
+    // Счетчики для анализа операций (работают при PHONEBOOK_LIFETIME_STATS)
+    inline static LifetimeCounter constructorCount;  // Конструктор по умолчанию
+    inline static LifetimeCounter copyCount;         // Копирование
+    inline static LifetimeCounter moveCount;         // Перемещение
+    inline static LifetimeCounter deleteCount;       // Удаление
+    inline static LifetimeCounter assignCount;       // Присваивание
+    inline static LifetimeCounter moveAssignCount;   // Перемещающее присваивание
 
 public:
     // Переносим методы валидации в public секцию
-    static bool validateName(const std::string& name);
-    static bool validateEmail(const std::string& email);
-    static bool validateDate(const std::string& date);
+    static bool validateName(std::string_view name);
+    static bool validateEmail(std::string_view email);
+    static bool validateDate(std::string_view date);
 
     // Конструктор по умолчанию
-    Contact() : id(-1) {
-        ++constructorCount;
-        qDebug() << "Default constructor called. Total:" << constructorCount;
+    Contact() : Contact(allocator_type()) {}
+
+    explicit Contact(const allocator_type& alloc)
+        : id(-1)
+        , firstName(alloc)
+        , lastName(alloc)
+        , middleName(alloc)
+        , birthDate(alloc)
+        , email(alloc)
+        , address(alloc)
+        , phoneNumbers(alloc)
+    {
+        constructorCount.increment();
     }
     
     // Конструктор копирования
-    Contact(const Contact& other) 
+    Contact(const Contact& other) : Contact(other, allocator_type()) {}
+
+    Contact(const Contact& other, const allocator_type& alloc)
         : id(other.id)
-        , firstName(other.firstName)
-        , lastName(other.lastName)
-        , middleName(other.middleName)
-        , birthDate(other.birthDate)
-        , email(other.email)
-        , address(other.address)
-        , phoneNumbers(other.phoneNumbers)
+        , firstName(other.firstName, alloc)
+        , lastName(other.lastName, alloc)
+        , middleName(other.middleName, alloc)
+        , birthDate(other.birthDate, alloc)
+        , email(other.email, alloc)
+        , address(other.address, alloc)
+        , phoneNumbers(other.phoneNumbers, alloc)
     {
-        ++copyCount;
-        qDebug() << "Contact copy constructor. Total copies:" << copyCount;
+        copyCount.increment();
     }
     
-    // Конструктор перемещения
+    // Конструктор перемещения (ресурс переезжает вместе со строками)
     Contact(Contact&& other) noexcept
         : id(other.id)
         , firstName(std::move(other.firstName))
@@ -64,11 +89,25 @@ public:
         , phoneNumbers(std::move(other.phoneNumbers))
     {
         other.id = -1;
-        ++moveCount;
-        qDebug() << "Contact move constructor. Total moves:" << moveCount;
+        moveCount.increment();
+    }
+
+    // Перемещение в другой ресурс: при разных ресурсах строки копируются
+    Contact(Contact&& other, const allocator_type& alloc)
+        : id(other.id)
+        , firstName(std::move(other.firstName), alloc)
+        , lastName(std::move(other.lastName), alloc)
+        , middleName(std::move(other.middleName), alloc)
+        , birthDate(std::move(other.birthDate), alloc)
+        , email(std::move(other.email), alloc)
+        , address(std::move(other.address), alloc)
+        , phoneNumbers(std::move(other.phoneNumbers), alloc)
+    {
+        other.id = -1;
+        moveCount.increment();
     }
     
-    // Оператор присваивания копированием
+    // Оператор присваивания копированием (ресурс остается прежним)
     Contact& operator=(const Contact& other) {
         if (this != &other) {
             id = other.id;
@@ -79,14 +118,14 @@ public:
             email = other.email;
             address = other.address;
             phoneNumbers = other.phoneNumbers;
-            ++assignCount;
-            qDebug() << "Contact copy assignment. Total:" << assignCount;
+            assignCount.increment();
         }
         return *this;
     }
     
-    // Оператор присваивания перемещением
-    Contact& operator=(Contact&& other) noexcept {
+    // Оператор присваивания перемещением. Не noexcept: если ресурсы
+    // разные, строки копируются в ресурс этого контакта
+    Contact& operator=(Contact&& other) {
         if (this != &other) {
             id = other.id;
             firstName = std::move(other.firstName);
@@ -97,19 +136,35 @@ public:
             address = std::move(other.address);
             phoneNumbers = std::move(other.phoneNumbers);
             other.id = -1;
-            ++moveAssignCount;
-            qDebug() << "Contact move assignment. Total:" << moveAssignCount;
+            moveAssignCount.increment();
         }
         return *this;
     }
     
     ~Contact() {
-        ++deleteCount;
-        qDebug() << "Destructor called. Total:" << deleteCount;
+        deleteCount.increment();
+    }
+
+    allocator_type get_allocator() const { return firstName.get_allocator(); }
+
+    // Контакт из записи хранилища. Данные проверялись при записи, поэтому
+    // поля переносятся как есть, без валидации: запись, которая не проходит
+    // нынешние правила, загружается целиком, а не обнуляется.
+    // Пользовательский ввод по-прежнему идет через проверяющие сеттеры
+    static Contact fromStorage(int id, std::string_view lastName, std::string_view firstName,
+                               std::string_view middleName, std::string_view birthDate,
+                               std::string_view address, std::string_view email,
+                               const allocator_type& alloc = allocator_type());
+    // Телефон из хранилища, тоже без проверки
+    void addStoredPhoneNumber(std::string_view number, std::string_view type) {
+        phoneNumbers.emplace_back(number, type);
     }
 
     // Статический метод для получения статистики
     static QString getStats() {
+        if (!kLifetimeStatsEnabled) {
+            return "Contact statistics are disabled (build with PHONEBOOK_LIFETIME_STATS)";
+        }
         return QString("Contact statistics:\n"
                       "- Default constructions: %1\n"
                       "- Copy constructions: %2\n"
@@ -117,42 +172,36 @@ public:
                       "- Copy assignments: %4\n"
                       "- Move assignments: %5\n"
                       "- Destructions: %6")
-            .arg(constructorCount)
-            .arg(copyCount)
-            .arg(moveCount)
-            .arg(assignCount)
-            .arg(moveAssignCount)
-            .arg(deleteCount);
+            .arg(constructorCount.value())
+            .arg(copyCount.value())
+            .arg(moveCount.value())
+            .arg(assignCount.value())
+            .arg(moveAssignCount.value())
+            .arg(deleteCount.value());
     }
 
-    // Переопределение new
-    void* operator new(size_t size) {
-        void* ptr = ::operator new(size);
-        qDebug() << "New operator called";
-        return ptr;
-    }
-    
-    // Геттеры
+    // Геттеры. Строки возвращаются как string_view на поля контакта (UTF-8)
+    // без копирования и действительны, пока поле не изменено
     int getId() const { return id; }
-    std::string getFirstName() const { return firstName; }
-    std::string getLastName() const { return lastName; }
-    std::string getMiddleName() const { return middleName; }
-    std::string getBirthDate() const { return birthDate; }
-    std::string getEmail() const { return email; }
-    std::string getAddress() const { return address; }
-    const std::vector<PhoneNumber>& getPhoneNumbers() const { return phoneNumbers; }
+    std::string_view getFirstName() const { return firstName; }
+    std::string_view getLastName() const { return lastName; }
+    std::string_view getMiddleName() const { return middleName; }
+    std::string_view getBirthDate() const { return birthDate; }
+    std::string_view getEmail() const { return email; }
+    std::string_view getAddress() const { return address; }
+    const PhoneList& getPhoneNumbers() const { return phoneNumbers; }
 
     // Сеттеры
     void setId(int newId) { id = newId; }
-    bool setFirstName(const std::string& name);
-    bool setLastName(const std::string& name);
-    bool setMiddleName(const std::string& name);
-    bool setBirthDate(const std::string& date);
-    bool setEmail(const std::string& email);
-    void setAddress(const std::string& addr);
+    bool setFirstName(std::string_view name);
+    bool setLastName(std::string_view name);
+    bool setMiddleName(std::string_view name);
+    bool setBirthDate(std::string_view date);
+    bool setEmail(std::string_view email);
+    void setAddress(std::string_view addr);
     void addPhoneNumber(const PhoneNumber& phone);
     void clearPhoneNumbers() { phoneNumbers.clear(); }
     void setPhoneNumbers(const std::vector<PhoneNumber>& numbers) {
-        phoneNumbers = numbers;
+        phoneNumbers.assign(numbers.begin(), numbers.end());
     }
 };
@@ -22,15 +22,15 @@ ContactDialog::ContactDialog(const Contact& initialContact, QWidget* parent)
     setupConnections();
 
     // Заполняем поля данными контакта
-    firstNameEdit->setText(QString::fromStdString(contact.getFirstName()));
-    lastNameEdit->setText(QString::fromStdString(contact.getLastName()));
-    middleNameEdit->setText(QString::fromStdString(contact.getMiddleName()));
-    emailEdit->setText(QString::fromStdString(contact.getEmail()));
-    addressEdit->setText(QString::fromStdString(contact.getAddress()));
+    firstNameEdit->setText(toQString(contact.getFirstName()));
+    lastNameEdit->setText(toQString(contact.getLastName()));
+    middleNameEdit->setText(toQString(contact.getMiddleName()));
+    emailEdit->setText(toQString(contact.getEmail()));
+    addressEdit->setText(toQString(contact.getAddress()));
     
     if (!contact.getBirthDate().empty()) {
         birthDateEdit->setDate(QDate::fromString(
-            QString::fromStdString(contact.getBirthDate()), 
+            toQString(contact.getBirthDate()), 
             "yyyy-MM-dd"
         ));
     }
@@ -126,20 +126,20 @@ bool ContactDialog::validateInputs() const {
     QString errorMsg;
     
     // Проверяем ФИО
-    if (!Contact::validateName(lastNameEdit->text().trimmed().toStdString())) {
+    if (!Contact::validateName(Utf8(lastNameEdit->text().trimmed()))) {
         errorMsg = "Некорректная фамилия";
     }
-    else if (!Contact::validateName(firstNameEdit->text().trimmed().toStdString())) {
+    else if (!Contact::validateName(Utf8(firstNameEdit->text().trimmed()))) {
         errorMsg = "Некорректное имя";
     }
     else if (!middleNameEdit->text().trimmed().isEmpty() && 
-             !Contact::validateName(middleNameEdit->text().trimmed().toStdString())) {
+             !Contact::validateName(Utf8(middleNameEdit->text().trimmed()))) {
         errorMsg = "Некорректное отчество";
     }
     
     // Проверяем email
     if (errorMsg.isEmpty() && !emailEdit->text().trimmed().isEmpty() && 
-        !Contact::validateEmail(emailEdit->text().trimmed().toStdString())) {
+        !Contact::validateEmail(Utf8(emailEdit->text().trimmed()))) {
         errorMsg = "Некорректный email";
     }
     
@@ -191,16 +191,16 @@ Contact ContactDialog::getContact() const {
     }
     
     // Устанавливаем значения и проверяем успешность
-    if (!contact.setLastName(lastNameEdit->text().trimmed().toStdString()) ||
-        !contact.setFirstName(firstNameEdit->text().trimmed().toStdString()) ||
-        !contact.setMiddleName(middleNameEdit->text().trimmed().toStdString()) ||
-        !contact.setEmail(emailEdit->text().trimmed().toStdString()) ||
-        !contact.setBirthDate(birthDateEdit->date().toString("yyyy-MM-dd").toStdString())) {
+    if (!contact.setLastName(Utf8(lastNameEdit->text().trimmed())) ||
+        !contact.setFirstName(Utf8(firstNameEdit->text().trimmed())) ||
+        !contact.setMiddleName(Utf8(middleNameEdit->text().trimmed())) ||
+        !contact.setEmail(Utf8(emailEdit->text().trimmed())) ||
+        !contact.setBirthDate(Utf8(birthDateEdit->date().toString("yyyy-MM-dd")))) {
         throw std::runtime_error("Ошибка при установке данных контакта");
     }
     
     // Адрес не требует валидации
-    contact.setAddress(addressEdit->text().trimmed().toStdString());
+    contact.setAddress(Utf8(addressEdit->text().trimmed()));
     
     // Добавляем телефоны
     for (const auto* widget : phoneWidgets) {
@@ -212,11 +212,11 @@ Contact ContactDialog::getContact() const {
 
 void ContactDialog::setContact(const Contact& newContact) {
     contact = newContact;
-    firstNameEdit->setText(QString::fromStdString(contact.getFirstName()));
-    lastNameEdit->setText(QString::fromStdString(contact.getLastName()));
-    middleNameEdit->setText(QString::fromStdString(contact.getMiddleName()));
-    emailEdit->setText(QString::fromStdString(contact.getEmail()));
-    addressEdit->setText(QString::fromStdString(contact.getAddress()));
+    firstNameEdit->setText(toQString(contact.getFirstName()));
+    lastNameEdit->setText(toQString(contact.getLastName()));
+    middleNameEdit->setText(toQString(contact.getMiddleName()));
+    emailEdit->setText(toQString(contact.getEmail()));
+    addressEdit->setText(toQString(contact.getAddress()));
     
     // Очищаем существующие телефоны
     clearPhoneWidgets();
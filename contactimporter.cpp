@@ -0,0 +1,592 @@
+#include "contactimporter.h"
+#include "contact.h"
+#include "phonebook.h"
+#include "phonekernel.h"
+#include "validation.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Format = ContactImporter::Format;
+
+const char* const kMobile = "Мобильный";
+const char* const kHome = "Домашний";
+const char* const kWork = "Рабочий";
+
+// Поля записи в том виде, в каком они пришли из файла
+struct RawRecord {
+    std::string lastName;
+    std::string firstName;
+    std::string middleName;
+    std::string birthDate;
+    std::string email;
+    std::string address;
+    std::vector<std::pair<std::string, const char*>> phones; // номер, тип
+
+    void clear() { *this = RawRecord(); }
+};
+
+enum class Column { Ignored, LastName, FirstName, MiddleName, BirthDate, Email, Address, Phone };
+
+struct ColumnSpec {
+    Column column;
+    const char* phoneType; // для Column::Phone
+};
+
+// Разделитель и столбцы CSV, определяются по первой строке файла
+struct CsvLayout {
+    char delimiter = ',';
+    std::vector<ColumnSpec> columns = {
+        {Column::LastName, nullptr}, {Column::FirstName, nullptr}, {Column::MiddleName, nullptr},
+        {Column::BirthDate, nullptr}, {Column::Email, nullptr}, {Column::Address, nullptr},
+        {Column::Phone, kMobile}
+    };
+};
+
+// Результат разбора одного блока; номера записей - от начала блока
+struct ParsedBlock {
+    std::vector<Contact> contacts;
+    std::vector<qint64> contactRecords; // номер записи каждого контакта
+    std::vector<std::pair<qint64, QString>> errors;
+    qint64 recordCount = 0;
+    qint64 bytes = 0;
+};
+
+bool equalsIgnoreCase(std::string_view text, std::string_view upper) {
+    return text.size() == upper.size() &&
+           std::equal(text.begin(), text.end(), upper.begin(), [](char a, char b) {
+               return (a >= 'a' && a <= 'z' ? char(a - 'a' + 'A') : a) == b;
+           });
+}
+
+bool startsWithIgnoreCase(std::string_view text, std::string_view upper) {
+    return text.size() >= upper.size() && equalsIgnoreCase(text.substr(0, upper.size()), upper);
+}
+
+// yyyy-MM-dd из yyyy-MM-dd, yyyyMMdd (vCard) или dd.MM.yyyy;
+// остальное возвращается как есть и не пройдет Contact::validateDate
+std::string normalizeDate(std::string_view date) {
+    if (date.size() == 8 && std::all_of(date.begin(), date.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+        return std::string(date.substr(0, 4)) + '-' + std::string(date.substr(4, 2)) + '-' +
+               std::string(date.substr(6, 2));
+    }
+    if (date.size() == 10 && date[2] == '.' && date[5] == '.') {
+        return std::string(date.substr(6, 4)) + '-' + std::string(date.substr(3, 2)) + '-' +
+               std::string(date.substr(0, 2));
+    }
+    return std::string(date);
+}
+
+// Проверка записи по правилам ContactDialog; телефоны приводятся к +7XXXXXXXXXX
+bool buildContact(const RawRecord& raw, Contact& contact, QString& error) {
+    std::string_view middleName = Validation::trimmed(raw.middleName);
+    std::string birthDate = normalizeDate(Validation::trimmed(raw.birthDate));
+
+    if (!contact.setLastName(Validation::trimmed(raw.lastName))) {
+        error = "Некорректная фамилия";
+    } else if (!contact.setFirstName(Validation::trimmed(raw.firstName))) {
+        error = "Некорректное имя";
+    } else if (!middleName.empty() && !Contact::validateName(middleName)) {
+        error = "Некорректное отчество";
+    } else if (!contact.setEmail(Validation::trimmed(raw.email))) {
+        error = "Некорректный email";
+    } else if (!Contact::validateDate(birthDate)) {
+        error = "Некорректная дата рождения";
+    }
+    if (!error.isEmpty()) {
+        return false;
+    }
+    contact.setMiddleName(middleName);
+    contact.setBirthDate(birthDate);
+    contact.setAddress(Validation::trimmed(raw.address));
+
+    for (const auto& phone : raw.phones) {
+        quint64 e164;
+        if (!PhoneKernel::normalize(phone.first, e164)) {
+            error = "Некорректный номер телефона: " + toQString(Validation::trimmed(phone.first));
+            return false;
+        }
+        contact.addStoredPhoneNumber(PhoneKernel::format(e164), phone.second);
+    }
+    return true;
+}
+
+void addRecord(const RawRecord& raw, ParsedBlock& block) {
+    qint64 record = block.recordCount++;
+    Contact contact;
+    QString error;
+    if (buildContact(raw, contact, error)) {
+        block.contacts.push_back(std::move(contact));
+        block.contactRecords.push_back(record);
+    } else {
+        block.errors.emplace_back(record, error);
+    }
+}
+
+// Номера из поля телефона; их может быть несколько через ',' или ';'
+void splitPhones(std::string_view field, const char* type, RawRecord& record) {
+    size_t pos = 0;
+    while (pos <= field.size()) {
+        size_t end = std::min(field.find_first_of(",;", pos), field.size());
+        std::string_view number = Validation::trimmed(field.substr(pos, end - pos));
+        if (!number.empty()) {
+            record.phones.emplace_back(std::string(number), type);
+        }
+        pos = end + 1;
+    }
+}
+
+// CSV
+
+// Поля одной записи с позиции pos; pos сдвигается за конец записи.
+// Внутри кавычек разделитель и перевод строки - часть поля, "" - кавычка
+void readCsvRecord(std::string_view text, size_t& pos, char delimiter, std::vector<std::string>& fields) {
+    fields.clear();
+    std::string field;
+    bool quoted = false;
+    while (pos < text.size()) {
+        char c = text[pos++];
+        if (quoted) {
+            if (c != '"') {
+                field += c;
+            } else if (pos < text.size() && text[pos] == '"') {
+                field += '"';
+                ++pos;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == delimiter) {
+            fields.push_back(std::move(field));
+            field.clear();
+        } else if (c == '\n') {
+            break;
+        } else if (c != '\r') {
+            field += c;
+        }
+    }
+    fields.push_back(std::move(field));
+}
+
+// Позиция за последним (или, если firstOnly, первым) переводом строки вне кавычек
+size_t csvBoundary(std::string_view text, bool firstOnly = false) {
+    size_t boundary = 0;
+    bool quoted = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '"') {
+            quoted = !quoted;
+        } else if (text[i] == '\n' && !quoted) {
+            boundary = i + 1;
+            if (firstOnly) {
+                break;
+            }
+        }
+    }
+    return boundary;
+}
+
+bool headerColumn(const std::string& name, ColumnSpec& spec) {
+    static const std::pair<const char*, ColumnSpec> kNames[] = {
+        {"фамилия", {Column::LastName, nullptr}}, {"lastname", {Column::LastName, nullptr}},
+        {"familyname", {Column::LastName, nullptr}}, {"surname", {Column::LastName, nullptr}},
+        {"имя", {Column::FirstName, nullptr}}, {"firstname", {Column::FirstName, nullptr}},
+        {"givenname", {Column::FirstName, nullptr}},
+        {"отчество", {Column::MiddleName, nullptr}}, {"middlename", {Column::MiddleName, nullptr}},
+        {"patronymic", {Column::MiddleName, nullptr}},
+        {"датарождения", {Column::BirthDate, nullptr}}, {"birthdate", {Column::BirthDate, nullptr}},
+        {"birthday", {Column::BirthDate, nullptr}}, {"bday", {Column::BirthDate, nullptr}},
+        {"email", {Column::Email, nullptr}}, {"почта", {Column::Email, nullptr}},
+        {"адрес", {Column::Address, nullptr}}, {"address", {Column::Address, nullptr}},
+        {"телефон", {Column::Phone, kMobile}}, {"телефоны", {Column::Phone, kMobile}},
+        {"phone", {Column::Phone, kMobile}}, {"phones", {Column::Phone, kMobile}},
+        {"tel", {Column::Phone, kMobile}}, {"мобильный", {Column::Phone, kMobile}},
+        {"mobile", {Column::Phone, kMobile}}, {"cell", {Column::Phone, kMobile}},
+        {"домашний", {Column::Phone, kHome}}, {"home", {Column::Phone, kHome}},
+        {"рабочий", {Column::Phone, kWork}}, {"work", {Column::Phone, kWork}},
+    };
+    // Регистр, пробелы, '_' и '-' в названиях не важны
+    QString key = QString::fromStdString(name).toLower();
+    key.remove(' ').remove('_').remove('-');
+    for (const auto& entry : kNames) {
+        if (key == QString::fromUtf8(entry.first)) {
+            spec = entry.second;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Разделитель и столбцы по первой строке. false - строка не заголовок, а данные
+bool readCsvHeader(std::string_view line, CsvLayout& layout) {
+    if (std::count(line.begin(), line.end(), ';') > std::count(line.begin(), line.end(), ',')) {
+        layout.delimiter = ';';
+    }
+    std::vector<std::string> fields;
+    size_t pos = 0;
+    readCsvRecord(line, pos, layout.delimiter, fields);
+
+    std::vector<ColumnSpec> columns;
+    bool known = false;
+    for (const auto& field : fields) {
+        ColumnSpec spec{Column::Ignored, nullptr};
+        known = headerColumn(field, spec) || known;
+        columns.push_back(spec);
+    }
+    if (known) {
+        layout.columns = std::move(columns);
+    }
+    return known;
+}
+
+void parseCsv(std::string_view text, const CsvLayout& layout, ParsedBlock& block) {
+    std::vector<std::string> fields;
+    RawRecord record;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        readCsvRecord(text, pos, layout.delimiter, fields);
+        if (fields.size() == 1 && Validation::trimmed(fields.front()).empty()) {
+            continue; // пустая строка - не запись
+        }
+
+        record.clear();
+        size_t count = std::min(fields.size(), layout.columns.size());
+        for (size_t i = 0; i < count; ++i) {
+            std::string& field = fields[i];
+            switch (layout.columns[i].column) {
+            case Column::LastName: record.lastName = std::move(field); break;
+            case Column::FirstName: record.firstName = std::move(field); break;
+            case Column::MiddleName: record.middleName = std::move(field); break;
+            case Column::BirthDate: record.birthDate = std::move(field); break;
+            case Column::Email: record.email = std::move(field); break;
+            case Column::Address: record.address = std::move(field); break;
+            case Column::Phone: splitPhones(field, layout.columns[i].phoneType, record); break;
+            case Column::Ignored: break;
+            }
+        }
+        addRecord(record, block);
+    }
+}
+
+// vCard
+
+// Строка без \r в конце
+std::string_view chompLine(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    return line;
+}
+
+// Позиция за последней строкой END:VCARD
+size_t vcardBoundary(std::string_view text) {
+    size_t boundary = 0;
+    size_t pos = 0;
+    size_t end;
+    while ((end = text.find('\n', pos)) != std::string_view::npos) {
+        if (equalsIgnoreCase(Validation::trimmed(text.substr(pos, end - pos)), "END:VCARD")) {
+            boundary = end + 1;
+        }
+        pos = end + 1;
+    }
+    return boundary;
+}
+
+// Логическая строка: строки, начинающиеся с пробела или табуляции,
+// продолжают предыдущую (RFC 6350, 3.2)
+bool nextUnfoldedLine(std::string_view text, size_t& pos, std::string& line) {
+    if (pos >= text.size()) {
+        return false;
+    }
+    line.clear();
+    bool continuation = false;
+    do {
+        size_t end = std::min(text.find('\n', pos), text.size());
+        std::string_view part = chompLine(text.substr(pos, end - pos));
+        line.append(continuation ? part.substr(std::min<size_t>(1, part.size())) : part);
+        continuation = true;
+        pos = end + 1;
+    } while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t'));
+    return true;
+}
+
+// Компоненты значения через separator с раскрытыми \\, \, \; и \n
+std::vector<std::string> splitValue(std::string_view value, char separator) {
+    std::vector<std::string> parts(1);
+    for (size_t i = 0; i < value.size(); ++i) {
+        char c = value[i];
+        if (c == '\\' && i + 1 < value.size()) {
+            char next = value[++i];
+            parts.back() += (next == 'n' || next == 'N') ? ' ' : next;
+        } else if (c == separator) {
+            parts.emplace_back();
+        } else {
+            parts.back() += c;
+        }
+    }
+    return parts;
+}
+
+// Тип телефона из параметров TEL: TYPE=cell,voice / TYPE="home" / CELL
+const char* phoneType(std::string_view params) {
+    size_t pos = 0;
+    while (pos < params.size()) {
+        size_t end = std::min(params.find_first_of(";,=\"", pos), params.size());
+        std::string_view token = params.substr(pos, end - pos);
+        if (equalsIgnoreCase(token, "CELL") || equalsIgnoreCase(token, "MOBILE")) {
+            return kMobile;
+        }
+        if (equalsIgnoreCase(token, "HOME")) {
+            return kHome;
+        }
+        if (equalsIgnoreCase(token, "WORK")) {
+            return kWork;
+        }
+        pos = end + 1;
+    }
+    return kMobile;
+}
+
+void parseVCards(std::string_view text, ParsedBlock& block) {
+    RawRecord record;
+    bool inCard = false;
+    std::string line;
+    size_t pos = 0;
+    while (nextUnfoldedLine(text, pos, line)) {
+        size_t colon = line.find(':');
+        if (colon == std::string::npos) {
+            continue;
+        }
+        std::string_view head = std::string_view(line).substr(0, colon);
+        std::string_view value = std::string_view(line).substr(colon + 1);
+        size_t semicolon = std::min(head.find(';'), head.size());
+        std::string_view name = head.substr(0, semicolon);
+        std::string_view params = head.substr(std::min(semicolon + 1, head.size()));
+        // Группа свойства (item1.TEL) не важна
+        size_t dot = name.find('.');
+        if (dot != std::string_view::npos) {
+            name = name.substr(dot + 1);
+        }
+
+        if (equalsIgnoreCase(name, "BEGIN")) {
+            record.clear();
+            inCard = true;
+        } else if (!inCard) {
+            continue;
+        } else if (equalsIgnoreCase(name, "END")) {
+            addRecord(record, block);
+            inCard = false;
+        } else if (equalsIgnoreCase(name, "N")) {
+            // Фамилия;Имя;Дополнительные имена;Префикс;Суффикс
+            std::vector<std::string> parts = splitValue(value, ';');
+            parts.resize(std::max<size_t>(parts.size(), 3));
+            record.lastName = std::move(parts[0]);
+            record.firstName = std::move(parts[1]);
+            record.middleName = std::move(parts[2]);
+        } else if (equalsIgnoreCase(name, "TEL")) {
+            // В vCard 4.0 номер может быть URI: tel:+7-812-123-45-67
+            if (startsWithIgnoreCase(value, "TEL:")) {
+                value.remove_prefix(4);
+            }
+            record.phones.emplace_back(std::string(value), phoneType(params));
+        } else if (equalsIgnoreCase(name, "EMAIL")) {
+            // У контакта один email - берем первый
+            if (record.email.empty()) {
+                record.email = splitValue(value, '\0').front();
+            }
+        } else if (equalsIgnoreCase(name, "BDAY")) {
+            record.birthDate = std::string(value);
+        } else if (equalsIgnoreCase(name, "ADR")) {
+            // Абонентский ящик;Дополнительно;Улица;Город;Регион;Индекс;Страна
+            std::string address;
+            for (const auto& part : splitValue(value, ';')) {
+                if (!Validation::trimmed(part).empty()) {
+                    address += address.empty() ? part : ", " + part;
+                }
+            }
+            record.address = std::move(address);
+        }
+    }
+
+    // Файл оборвался внутри карточки
+    if (inCard) {
+        block.errors.emplace_back(block.recordCount++, "Запись vCard не завершена (нет END:VCARD)");
+    }
+}
+
+std::shared_ptr<ParsedBlock> parseBlock(const QByteArray& data, Format format, const CsvLayout& layout) {
+    auto block = std::make_shared<ParsedBlock>();
+    block->bytes = data.size();
+    std::string_view text(data.constData(), size_t(data.size()));
+    if (format == Format::Csv) {
+        parseCsv(text, layout, *block);
+    } else {
+        parseVCards(text, *block);
+    }
+    return block;
+}
+
+} // namespace
+
+ContactImporter::ContactImporter(PhoneBook* phoneBook, QObject* parent)
+    : QObject(parent)
+    , m_phoneBook(phoneBook)
+{
+    // Один поток читает файл и ждет результатов, остальные разбирают блоки
+    m_pool.setMaxThreadCount(QThread::idealThreadCount() + 1);
+}
+
+ContactImporter::~ContactImporter() {
+    // Фоновый импорт обращается к this и к книге - дожидаемся его
+    cancel();
+    m_task.waitForFinished();
+}
+
+ContactImporter::Format ContactImporter::formatForFile(const QString& fileName) {
+    QString suffix = QFileInfo(fileName).suffix().toLower();
+    return suffix == "vcf" || suffix == "vcard" ? Format::VCard : Format::Csv;
+}
+
+bool ContactImporter::start(const QString& fileName) {
+    return start(fileName, formatForFile(fileName));
+}
+
+bool ContactImporter::start(const QString& fileName, Format format) {
+    if (isRunning()) {
+        m_lastError = "Импорт уже выполняется";
+        return false;
+    }
+    auto file = std::make_shared<QFile>(fileName);
+    if (!file->open(QIODevice::ReadOnly)) {
+        m_lastError = "Не удалось открыть файл: " + file->errorString();
+        return false;
+    }
+    m_cancelled = false;
+    m_task = QtConcurrent::run(&m_pool, [this, file, format]() { run(file, format); });
+    return true;
+}
+
+void ContactImporter::cancel() {
+    m_cancelled = true;
+}
+
+bool ContactImporter::isRunning() const {
+    return m_task.isRunning();
+}
+
+void ContactImporter::run(std::shared_ptr<QFile> file, Format format) {
+    const qint64 total = file->size();
+    // Блоков в работе - по два на поток разбора: пока один разбирается,
+    // следующий уже прочитан
+    const int maxPending = std::max(2, (m_pool.maxThreadCount() - 1) * 2);
+
+    qint64 processed = 0;
+    qint64 imported = 0;
+    qint64 failed = 0;
+    qint64 reported = 0;
+    qint64 nextRecord = 1;
+
+    // Блоки добавляются в книгу строго в порядке файла
+    auto commit = [&](ParsedBlock& block) {
+        if (!block.contacts.empty()) {
+            std::vector<bool> results = m_phoneBook->addContacts(block.contacts);
+            for (size_t i = 0; i < results.size(); ++i) {
+                if (results[i]) {
+                    ++imported;
+                } else {
+                    block.errors.emplace_back(block.contactRecords[i],
+                                              "Ошибка хранилища: " + m_phoneBook->getLastError());
+                }
+            }
+        }
+        // Ошибки хранилища дописаны в конец - восстанавливаем порядок записей
+        std::sort(block.errors.begin(), block.errors.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (const auto& error : block.errors) {
+            ++failed;
+            if (reported < kMaxReportedErrors) {
+                ++reported;
+                emit recordFailed(nextRecord + error.first, error.second);
+            }
+        }
+        nextRecord += block.recordCount;
+        processed += block.bytes;
+        emit progress(processed, total);
+    };
+
+    CsvLayout layout;
+    bool headerRead = format != Format::Csv;
+    bool firstChunk = true;
+    QString error;
+    QByteArray buffer; // начало записи, не поместившейся в прошлый блок
+    std::deque<QFuture<std::shared_ptr<ParsedBlock>>> pending;
+
+    while (!m_cancelled) {
+        QByteArray data = file->read(kChunkSize);
+        if (file->error() != QFile::NoError) {
+            error = "Ошибка чтения файла: " + file->errorString();
+            break;
+        }
+        const bool atEnd = file->atEnd() || data.isEmpty();
+        buffer += data;
+
+        if (firstChunk && buffer.startsWith("\xEF\xBB\xBF")) {
+            buffer.remove(0, 3); // BOM
+            processed += 3;
+        }
+        firstChunk = false;
+
+        if (!headerRead) {
+            size_t end = csvBoundary(std::string_view(buffer.constData(), size_t(buffer.size())), true);
+            if (end == 0 && !atEnd) {
+                continue; // первая строка еще не прочитана целиком
+            }
+            end = end == 0 ? size_t(buffer.size()) : end;
+            if (readCsvHeader(std::string_view(buffer.constData(), end), layout)) {
+                buffer.remove(0, int(end));
+                processed += qint64(end);
+            }
+            headerRead = true;
+        }
+
+        std::string_view text(buffer.constData(), size_t(buffer.size()));
+        size_t boundary = atEnd ? text.size()
+                                : (format == Format::Csv ? csvBoundary(text) : vcardBoundary(text));
+        if (boundary > 0) {
+            QByteArray chunk = buffer.left(int(boundary));
+            buffer.remove(0, int(boundary));
+            if (int(pending.size()) >= maxPending) {
+                commit(*pending.front().result());
+                pending.pop_front();
+            }
+            pending.push_back(QtConcurrent::run(&m_pool, [chunk, format, layout]() {
+                return parseBlock(chunk, format, layout);
+            }));
+        }
+        // Иначе запись длиннее блока - дочитываем
+        if (atEnd) {
+            break;
+        }
+    }
+
+    // Разобранные после отмены блоки в книгу не попадают
+    for (auto& block : pending) {
+        if (m_cancelled) {
+            break;
+        }
+        commit(*block.result());
+    }
+    if (m_cancelled && error.isEmpty()) {
+        error = "Импорт отменен";
+    }
+    emit finished(imported, failed, error);
+}
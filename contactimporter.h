@@ -0,0 +1,71 @@
+#pragma once
+#include <QObject>
+#include <QFuture>
+#include <QThreadPool>
+#include <QString>
+#include <atomic>
+#include <memory>
+
+class PhoneBook;
+class QFile;
+
+// Импорт контактов из CSV и vCard 3.0/4.0.
+// Файл читается блоками по kChunkSize, каждый блок обрезается по границе
+// последней целой записи. Блоки разбираются параллельно, а в книгу попадают
+// по порядку, по одному пакету PhoneBook::addContacts на блок. В работе
+// одновременно не больше нескольких блоков на поток, поэтому память не
+// зависит от размера файла. У импорта свой пул потоков: поток чтения ждет
+// разбора блоков, и в общем пуле он занимал бы потоки фонового поиска.
+// Записи проверяются по правилам Contact/PhoneNumber: ФИО и email - как в
+// ContactDialog, телефоны приводятся к +7XXXXXXXXXX (PhoneKernel).
+// Запись с ошибкой пропускается и сообщается сигналом recordFailed.
+// Сигналы приходят из фонового потока (в GUI - через очередь).
+//
+// CSV: разделитель ',' или ';' (по первой строке), поля в кавычках по RFC 4180.
+// Первая строка - заголовок, если в ней есть известные названия столбцов
+// (Фамилия, Имя, Отчество, Дата рождения, Email, Адрес, Телефон/Мобильный/
+// Домашний/Рабочий или их английские варианты); иначе столбцы идут в этом
+// порядке. В поле телефона может быть несколько номеров через ',' или ';'.
+class ContactImporter : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Format { Csv, VCard };
+
+    explicit ContactImporter(PhoneBook* phoneBook, QObject* parent = nullptr);
+    ~ContactImporter();
+
+    // .vcf и .vcard - vCard, остальное - CSV
+    static Format formatForFile(const QString& fileName);
+
+    // Запуск импорта в фоне; false, если файл не открылся или импорт уже идет
+    bool start(const QString& fileName);
+    bool start(const QString& fileName, Format format);
+    // Уже добавленные контакты остаются в книге
+    void cancel();
+    bool isRunning() const;
+    QString getLastError() const { return m_lastError; }
+
+signals:
+    // Обработано processedBytes из totalBytes, все эти записи уже в книге
+    void progress(qint64 processedBytes, qint64 totalBytes);
+    // Запись с номером record (с 1, без заголовка CSV) не импортирована.
+    // Сообщается не больше kMaxReportedErrors записей, остальные только считаются
+    void recordFailed(qint64 record, const QString& reason);
+    // error пуст, если файл прочитан целиком
+    void finished(qint64 imported, qint64 failed, const QString& error);
+
+private:
+    static constexpr qint64 kChunkSize = 1 << 20;
+    static constexpr int kMaxReportedErrors = 1000;
+
+    PhoneBook* m_phoneBook;
+    QString m_lastError;
+    std::atomic<bool> m_cancelled{false};
+    // Объявлен до m_task: разрушается последним и дожидается брошенных
+    // после отмены задач разбора
+    QThreadPool m_pool;
+    QFuture<void> m_task;
+
+    void run(std::shared_ptr<QFile> file, Format format);
+};
@@ -0,0 +1,295 @@
+#include "contacttablemodel.h"
+#include "phonebook.h"
+#include <QFutureWatcher>
+#include <algorithm>
+
+namespace {
+
+// Сколько контактов читается из хранилища за один fetchMore
+constexpr int kPageSize = 200;
+
+bool keyLess(std::string_view lastName, int id, std::string_view otherLastName, int otherId) {
+    int cmp = lastName.compare(otherLastName);
+    return cmp < 0 || (cmp == 0 && id < otherId);
+}
+
+} // namespace
+
+ContactTableModel::ContactTableModel(PhoneBook* phoneBook, QObject* parent)
+    : QAbstractTableModel(parent)
+    , m_phoneBook(phoneBook)
+    , m_atEnd(false)
+    , m_searchSerial(0)
+{
+    m_searchTimer.setSingleShot(true);
+    m_searchTimer.setInterval(kSearchDelayMs);
+    connect(&m_searchTimer, &QTimer::timeout, this, &ContactTableModel::startSearch);
+
+    connect(m_phoneBook, &PhoneBook::contactAdded, this, &ContactTableModel::onContactAdded);
+    connect(m_phoneBook, &PhoneBook::contactUpdated, this, &ContactTableModel::onContactUpdated);
+    connect(m_phoneBook, &PhoneBook::contactRemoved, this, &ContactTableModel::onContactRemoved);
+    connect(m_phoneBook, &PhoneBook::contactsChanged, this, &ContactTableModel::onContactsChanged);
+
+    reload();
+}
+
+int ContactTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : static_cast<int>(m_rows.size());
+}
+
+int ContactTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant ContactTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole ||
+        index.row() >= static_cast<int>(m_rows.size())) {
+        return QVariant();
+    }
+
+    const Contact& contact = m_rows[index.row()];
+    switch (index.column()) {
+    case LastNameColumn:
+        return toQString(contact.getLastName());
+    case FirstNameColumn:
+        return toQString(contact.getFirstName());
+    case MiddleNameColumn:
+        return toQString(contact.getMiddleName());
+    case BirthDateColumn:
+        return toQString(contact.getBirthDate());
+    case AddressColumn:
+        return toQString(contact.getAddress());
+    case EmailColumn:
+        return toQString(contact.getEmail());
+    case PhonesColumn:
+        return phonesText(contact);
+    default:
+        return QVariant();
+    }
+}
+
+QVariant ContactTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case LastNameColumn: return "Фамилия";
+    case FirstNameColumn: return "Имя";
+    case MiddleNameColumn: return "Отчество";
+    case BirthDateColumn: return "Дата рождения";
+    case AddressColumn: return "Адрес";
+    case EmailColumn: return "Email";
+    case PhonesColumn: return "Телефоны";
+    default: return QVariant();
+    }
+}
+
+bool ContactTableModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && !m_atEnd;
+}
+
+void ContactTableModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid()) {
+        return;
+    }
+
+    std::vector<Contact> page = m_phoneBook->getContactsPage(m_cursor, kPageSize);
+    if (static_cast<int>(page.size()) < kPageSize) {
+        m_atEnd = true;
+    }
+    if (page.empty()) {
+        return;
+    }
+    m_cursor = ContactPageKey::after(page.back());
+
+    int first = static_cast<int>(m_rows.size());
+    beginInsertRows(QModelIndex(), first, first + static_cast<int>(page.size()) - 1);
+    for (auto& contact : page) {
+        m_keys[contact.getId()] = contact.getLastName();
+        m_rows.push_back(std::move(contact));
+    }
+    endInsertRows();
+}
+
+void ContactTableModel::setFilter(const QString& query) {
+    if (query == m_filter) {
+        return;
+    }
+    m_filter = query;
+
+    if (m_filter.isEmpty()) {
+        // Результат запущенного поиска больше не нужен
+        m_searchTimer.stop();
+        ++m_searchSerial;
+        m_phoneBook->cancelSearches();
+        reload();
+    } else {
+        // Каждое нажатие откладывает поиск; запустится только последний запрос
+        m_searchTimer.start();
+    }
+}
+
+void ContactTableModel::reload() {
+    if (!m_filter.isEmpty()) {
+        startSearch();
+        return;
+    }
+
+    beginResetModel();
+    m_rows.clear();
+    m_keys.clear();
+    m_cursor = ContactPageKey();
+    m_atEnd = false;
+    endResetModel();
+
+    fetchMore(QModelIndex());
+}
+
+int ContactTableModel::contactId(int row) const {
+    if (row < 0 || row >= static_cast<int>(m_rows.size())) {
+        return -1;
+    }
+    return m_rows[row].getId();
+}
+
+void ContactTableModel::startSearch() {
+    m_searchTimer.stop();
+    int serial = ++m_searchSerial;
+
+    auto* watcher = new QFutureWatcher<std::vector<Contact>>(this);
+    connect(watcher, &QFutureWatcher<std::vector<Contact>>::finished, this, [this, watcher, serial]() {
+        // Результаты устаревших запросов (они к тому же прерваны) отбрасываем
+        if (serial == m_searchSerial) {
+            setResults(watcher->result());
+        }
+        watcher->deleteLater();
+    });
+    watcher->setFuture(m_phoneBook->findContactsAsync(m_filter));
+}
+
+void ContactTableModel::setResults(std::vector<Contact>&& contacts) {
+    beginResetModel();
+    m_rows = std::move(contacts);
+    m_keys.clear();
+    for (const auto& contact : m_rows) {
+        m_keys[contact.getId()] = contact.getLastName();
+    }
+    // Результат поиска загружается целиком
+    m_atEnd = true;
+    endResetModel();
+}
+
+void ContactTableModel::onContactAdded(int id) {
+    refreshContact(id);
+}
+
+void ContactTableModel::onContactUpdated(int id) {
+    refreshContact(id);
+}
+
+void ContactTableModel::onContactRemoved(int id) {
+    if (!m_filter.isEmpty()) {
+        m_searchTimer.start();
+        return;
+    }
+    removeContactRow(id);
+}
+
+void ContactTableModel::onContactsChanged(const QVector<int>& ids) {
+    if (!m_filter.isEmpty()) {
+        m_searchTimer.start();
+        return;
+    }
+    // Большой пакет (импорт) дешевле перечитать с первой страницы,
+    // чем искать место каждого контакта по отдельности
+    if (ids.size() > kPageSize) {
+        reload();
+        return;
+    }
+    for (int id : ids) {
+        refreshContact(id);
+    }
+}
+
+void ContactTableModel::refreshContact(int id) {
+    if (!m_filter.isEmpty()) {
+        // Совпадение с запросом определяет хранилище - повторяем поиск в фоне
+        m_searchTimer.start();
+        return;
+    }
+
+    Contact contact;
+    bool visible = m_phoneBook->getContact(id, contact) &&
+                   isLoaded(contact.getLastName(), id);
+    std::string lastName(contact.getLastName());
+
+    auto key = m_keys.find(id);
+    if (key != m_keys.end()) {
+        if (visible && key->second == lastName) {
+            // Позиция в порядке (фамилия, id) не изменилась - обновляем строку на месте
+            int row = findRow(lastName, id);
+            m_rows[row] = std::move(contact);
+            emit dataChanged(index(row, 0), index(row, ColumnCount - 1));
+            return;
+        }
+        removeContactRow(id);
+    }
+
+    // Контакты за курсором появятся при следующем fetchMore
+    if (!visible) {
+        return;
+    }
+
+    int row = insertPosition(lastName, id);
+    beginInsertRows(QModelIndex(), row, row);
+    m_keys[id] = lastName;
+    m_rows.insert(m_rows.begin() + row, std::move(contact));
+    endInsertRows();
+}
+
+void ContactTableModel::removeContactRow(int id) {
+    auto key = m_keys.find(id);
+    if (key == m_keys.end()) {
+        return;
+    }
+
+    int row = findRow(key->second, id);
+    m_keys.erase(key);
+    if (row < 0) {
+        return;
+    }
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rows.erase(m_rows.begin() + row);
+    endRemoveRows();
+}
+
+int ContactTableModel::findRow(std::string_view lastName, int id) const {
+    int row = insertPosition(lastName, id);
+    if (row < static_cast<int>(m_rows.size()) && m_rows[row].getId() == id) {
+        return row;
+    }
+    return -1;
+}
+
+int ContactTableModel::insertPosition(std::string_view lastName, int id) const {
+    auto it = std::lower_bound(m_rows.begin(), m_rows.end(), id,
+        [&lastName](const Contact& row, int rowId) {
+            return keyLess(row.getLastName(), row.getId(), lastName, rowId);
+        });
+    return static_cast<int>(it - m_rows.begin());
+}
+
+bool ContactTableModel::isLoaded(std::string_view lastName, int id) const {
+    return m_atEnd || !keyLess(m_cursor.lastName, m_cursor.id, lastName, id);
+}
+
+QString ContactTableModel::phonesText(const Contact& contact) {
+    QString phones;
+    for (const auto& phone : contact.getPhoneNumbers()) {
+        if (!phones.isEmpty()) phones += "\n";
+        phones += toQString(phone.getType()) + ": " +
+                  toQString(phone.getNumber());
+    }
+    return phones;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QTimer>
+#include <QVector>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "contact.h"
+#include "istorage.h"
+
+class PhoneBook;
+
+// Модель таблицы контактов поверх PhoneBook.
+// Без фильтра контакты читаются страницами в порядке (фамилия, id) по мере
+// прокрутки (canFetchMore/fetchMore), строки для отображения формируются в data()
+// прямо из UTF-8 полей контакта, без промежуточных копий.
+// Изменения книги приходят сигналами PhoneBook и затрагивают только
+// соответствующие строки.
+// С фильтром поиск выполняется в фоне после паузы в наборе; показывается
+// только результат последнего запроса.
+class ContactTableModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    enum Column {
+        LastNameColumn,
+        FirstNameColumn,
+        MiddleNameColumn,
+        BirthDateColumn,
+        AddressColumn,
+        EmailColumn,
+        PhonesColumn,
+        ColumnCount
+    };
+
+    explicit ContactTableModel(PhoneBook* phoneBook, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    // Строка поиска; пустая - показываются все контакты
+    void setFilter(const QString& query);
+    // Пауза в наборе, после которой запускается поиск
+    static constexpr int kSearchDelayMs = 250;
+    // Сбрасывает загруженные строки и читает книгу заново
+    void reload();
+    int contactId(int row) const;
+
+private slots:
+    void onContactAdded(int id);
+    void onContactUpdated(int id);
+    void onContactRemoved(int id);
+    void onContactsChanged(const QVector<int>& ids);
+
+private:
+    PhoneBook* m_phoneBook;
+    QString m_filter;
+    std::vector<Contact> m_rows;          // загруженные строки по (фамилия, id)
+    std::unordered_map<int, std::string> m_keys; // id -> фамилия загруженной строки
+    ContactPageKey m_cursor;              // последний просмотренный контакт книги
+    bool m_atEnd;
+    QTimer m_searchTimer;
+    int m_searchSerial;                   // номер последнего запущенного поиска
+
+    void startSearch();
+    void setResults(std::vector<Contact>&& contacts);
+    void refreshContact(int id);
+    void removeContactRow(int id);
+    int findRow(std::string_view lastName, int id) const;
+    int insertPosition(std::string_view lastName, int id) const;
+    bool isLoaded(std::string_view lastName, int id) const;
+    static QString phonesText(const Contact& contact);
+};
@@ -4,8 +4,19 @@
 #include <QVariant>
 #include <QDebug>
 #include <QFile>
+#include <QThread>
+#include <QMutexLocker>
+#include "searchindex.h"
+#include <algorithm>
 #include <memory>
 
+namespace {
+// Текущая версия схемы (PRAGMA user_version), см. migrateSchema()
+constexpr int kSchemaVersion = 2;
+// Сколько контактов обрабатывает один запрос телефонов (ограничение SQLite - 999 параметров)
+constexpr int kPhoneBatchSize = 256;
+}
+
 DatabaseManager::DatabaseManager(const QString& path, QObject *parent)
     : QObject(parent)
     , dbPath(path)
@@ -21,7 +32,7 @@ DatabaseManager::DatabaseManager(const QString& path, QObject *parent)
 DatabaseManager::~DatabaseManager()
 {
     if (db.isOpen()) {
-        db.close();
+        close();
     }
 }
 
@@ -40,11 +51,22 @@ bool DatabaseManager::init()
         return false;
     }
 
+    if (!migrateSchema()) {
+        qDebug() << "Failed to migrate schema:" << m_lastError;  // Для отладки
+        close();
+        return false;
+    }
+
     if (!createIndexes()) {
         close();
         return false;
     }
 
+    // Полнотекстовый индекс не обязателен: без FTS5 поиск идет через LIKE
+    m_hasFullTextIndex = createSearchIndex();
+
+    // Схема могла измениться - ранее подготовленные запросы больше не годятся
+    invalidateStatements();
     return true;
 }
 
@@ -59,6 +81,14 @@ bool DatabaseManager::open()
 
 void DatabaseManager::close()
 {
+    // Подготовленные запросы привязаны к соединению
+    invalidateStatements();
+    QMutexLocker locker(&m_threadsMutex);
+    for (auto it = m_workerConnections.cbegin(); it != m_workerConnections.cend(); ++it) {
+        disconnect(it.key(), &QThread::finished, this, nullptr);
+        QSqlDatabase::removeDatabase(it.value());
+    }
+    m_workerConnections.clear();
     db.close();
 }
 
@@ -67,19 +97,21 @@ bool DatabaseManager::isOpen() const
     return db.isOpen();
 }
 
+// Транзакция открывается на соединении текущего потока: запросы пакета
+// (statement()) выполняются именно на нем, а не на основном db
 bool DatabaseManager::beginTransaction()
 {
-    return db.transaction();
+    return connection().transaction();
 }
 
 bool DatabaseManager::commitTransaction()
 {
-    return db.commit();
+    return connection().commit();
 }
 
 bool DatabaseManager::rollbackTransaction()
 {
-    return db.rollback();
+    return connection().rollback();
 }
 
 bool DatabaseManager::initialize()
@@ -87,165 +119,496 @@ bool DatabaseManager::initialize()
     return init();
 }
 
-bool DatabaseManager::addContact(const Contact& contact)
+namespace {
+void bindContactFields(QSqlQuery& query, const Contact& contact)
 {
-    if (!isOpen() && !open()) {
-        return false;
+    query.bindValue(":first_name", toQString(contact.getFirstName()));
+    query.bindValue(":last_name", toQString(contact.getLastName()));
+    query.bindValue(":middle_name", toQString(contact.getMiddleName()));
+    query.bindValue(":birth_date", toQString(contact.getBirthDate()));
+    query.bindValue(":address", toQString(contact.getAddress()));
+    query.bindValue(":email", toQString(contact.getEmail()));
+    query.bindValue(":last_name_key", QString::fromStdString(
+        SearchIndex::fold(toQString(contact.getLastName()))));
+}
+
+// Верхняя граница диапазона строк с данным префиксом: U+10FFFF больше
+// любого символа, который может идти после префикса
+QString prefixUpperBound(const QString& prefix)
+{
+    return prefix + QString::fromUcs4(U"\U0010FFFF");
+}
+}
+
+const char* DatabaseManager::statementSql(Statement id)
+{
+    switch (id) {
+    case Statement::InsertContact:
+        return "INSERT INTO contacts (first_name, last_name, middle_name, birth_date, address, email, last_name_key) "
+               "VALUES (:first_name, :last_name, :middle_name, :birth_date, :address, :email, :last_name_key)";
+    case Statement::UpdateContact:
+        return "UPDATE contacts SET first_name=:first_name, last_name=:last_name, "
+               "middle_name=:middle_name, birth_date=:birth_date, address=:address, "
+               "email=:email, last_name_key=:last_name_key WHERE id=:id";
+    case Statement::DeleteContact:
+        return "DELETE FROM contacts WHERE id=:id";
+    case Statement::InsertPhone:
+        return "INSERT INTO phone_numbers (contact_id, number, type, normalized_number) "
+               "VALUES (:contact_id, :number, :type, :normalized_number)";
+    case Statement::DeletePhones:
+        return "DELETE FROM phone_numbers WHERE contact_id=:id";
+    case Statement::SelectPhonesBatch: {
+        static const QByteArray sql = [] {
+            QByteArray placeholders;
+            for (int i = 0; i < kPhoneBatchSize; ++i) {
+                placeholders += i == 0 ? "?" : ", ?";
+            }
+            return "SELECT contact_id, number, type FROM phone_numbers "
+                   "WHERE contact_id IN (" + placeholders + ") ORDER BY contact_id, id";
+        }();
+        return sql.constData();
+    }
+    case Statement::SelectAllContacts:
+        return "SELECT c.id, c.last_name, c.first_name, c.middle_name, "
+               "c.birth_date, c.address, c.email, "
+               "p.number, p.type "
+               "FROM contacts c "
+               "LEFT JOIN phone_numbers p ON c.id = p.contact_id "
+               "ORDER BY c.id";
+    case Statement::SelectContact:
+        return "SELECT c.id, c.last_name, c.first_name, c.middle_name, "
+               "c.birth_date, c.address, c.email, "
+               "p.number, p.type "
+               "FROM contacts c "
+               "LEFT JOIN phone_numbers p ON c.id = p.contact_id "
+               "WHERE c.id = :id";
+    case Statement::FindContacts:
+        return "SELECT DISTINCT c.id, c.first_name, c.last_name, c.middle_name, "
+               "c.birth_date, c.address, c.email "
+               "FROM contacts c "
+               "LEFT JOIN phone_numbers p ON c.id = p.contact_id "
+               "WHERE c.first_name LIKE :pattern "
+               "OR c.last_name LIKE :pattern "
+               "OR c.email LIKE :pattern "
+               "OR p.number LIKE :pattern";
+    case Statement::FindContactsFts:
+        return "SELECT c.id, c.first_name, c.last_name, c.middle_name, "
+               "c.birth_date, c.address, c.email "
+               "FROM contacts_fts f "
+               "JOIN contacts c ON c.id = f.rowid "
+               "WHERE contacts_fts MATCH :query "
+               "ORDER BY f.rank";
+    // Запрос из цифр и символов номера ищется и как текст, и как часть
+    // номера: "4567" находит +78121234567, как подстрока в SearchIndex
+    case Statement::FindContactsOrPhone:
+        return "SELECT DISTINCT c.id, c.first_name, c.last_name, c.middle_name, "
+               "c.birth_date, c.address, c.email "
+               "FROM contacts c "
+               "LEFT JOIN phone_numbers p ON c.id = p.contact_id "
+               "WHERE c.first_name LIKE :pattern "
+               "OR c.last_name LIKE :pattern "
+               "OR c.email LIKE :pattern "
+               "OR p.number LIKE :pattern "
+               "OR p.normalized_number LIKE :digits";
+    case Statement::FindContactsFtsOrPhone:
+        return "SELECT c.id, c.first_name, c.last_name, c.middle_name, "
+               "c.birth_date, c.address, c.email "
+               "FROM contacts c "
+               "WHERE c.id IN (SELECT rowid FROM contacts_fts WHERE contacts_fts MATCH :query) "
+               "OR c.id IN (SELECT contact_id FROM phone_numbers WHERE normalized_number LIKE :digits) "
+               "ORDER BY c.id";
+    case Statement::FindByPhone:
+        return "SELECT DISTINCT c.id, c.first_name, c.last_name, c.middle_name, "
+               "c.birth_date, c.address, c.email "
+               "FROM phone_numbers p "
+               "JOIN contacts c ON c.id = p.contact_id "
+               "WHERE p.normalized_number = :number";
+    case Statement::FindByPhonePrefix:
+        return "SELECT DISTINCT c.id, c.first_name, c.last_name, c.middle_name, "
+               "c.birth_date, c.address, c.email "
+               "FROM phone_numbers p "
+               "JOIN contacts c ON c.id = p.contact_id "
+               "WHERE p.normalized_number >= :from AND p.normalized_number < :to";
+    case Statement::CompleteLastName:
+        // Одна строка на каждый ключ; диапазон по ключу идет по idx_contacts_last_name_key
+        return "SELECT last_name FROM contacts "
+               "WHERE last_name_key >= :from AND last_name_key < :to "
+               "GROUP BY last_name_key ORDER BY last_name_key LIMIT :limit";
+    case Statement::FindByLastNamePrefix:
+        return "SELECT c.id, c.first_name, c.last_name, c.middle_name, "
+               "c.birth_date, c.address, c.email "
+               "FROM contacts c "
+               "WHERE c.last_name_key >= :from AND c.last_name_key < :to "
+               "ORDER BY c.last_name_key, c.id LIMIT :limit";
+    case Statement::SelectContactsPage:
+        // Сравнение кортежей идет по индексу idx_contacts_last_name
+        return "SELECT id, first_name, last_name, middle_name, birth_date, address, email "
+               "FROM contacts "
+               "WHERE (last_name, id) > (:last_name, :id) "
+               "ORDER BY last_name, id "
+               "LIMIT :limit";
+    case Statement::Savepoint:
+        return "SAVEPOINT batch_item";
+    case Statement::RollbackToSavepoint:
+        return "ROLLBACK TO batch_item";
+    case Statement::ReleaseSavepoint:
+        return "RELEASE batch_item";
     }
+    return "";
+}
 
-    beginTransaction();
+QSqlQuery& DatabaseManager::statement(Statement id) const
+{
+    // Запрос компилируется один раз, дальше только перепривязываются параметры.
+    // Узлы unordered_map не перемещаются, поэтому ссылка остается верной,
+    // пока кэш другого потока меняется под мьютексом
+    QSqlDatabase database = connection();
+    QMutexLocker locker(&m_threadsMutex);
+    StatementCache& cache = m_statements[QThread::currentThread()];
+    auto it = cache.find(id);
+    if (it != cache.end()) {
+        return it->second;
+    }
 
-    QSqlQuery query(db);
-    query.prepare("INSERT INTO contacts (first_name, last_name, middle_name, birth_date, address, email) "
-                 "VALUES (:first_name, :last_name, :middle_name, :birth_date, :address, :email)");
-    
-    query.bindValue(":first_name", QString::fromStdString(contact.getFirstName()));
-    query.bindValue(":last_name", QString::fromStdString(contact.getLastName()));
-    query.bindValue(":middle_name", QString::fromStdString(contact.getMiddleName()));
-    query.bindValue(":birth_date", QString::fromStdString(contact.getBirthDate()));
-    query.bindValue(":address", QString::fromStdString(contact.getAddress()));
-    query.bindValue(":email", QString::fromStdString(contact.getEmail()));
+    QSqlQuery query(database);
+    if (!query.prepare(statementSql(id))) {
+        qDebug() << "Failed to prepare statement:" << query.lastError().text();
+    }
+    return cache.emplace(id, std::move(query)).first->second;
+}
+
+QSqlDatabase DatabaseManager::connection() const
+{
+    // Соединение QSqlDatabase можно использовать только в создавшем его потоке
+    QThread* current = QThread::currentThread();
+    if (current == thread()) {
+        return db;
+    }
+
+    QMutexLocker locker(&m_threadsMutex);
+    auto it = m_workerConnections.constFind(current);
+    if (it != m_workerConnections.cend()) {
+        return QSqlDatabase::database(it.value());
+    }
+
+    // Потоки пула завершаются после простоя, а адрес QThread может достаться
+    // новому потоку - поэтому имя берется из счетчика, а соединение и запросы
+    // потока удаляются по его finished (сигнал приходит в самом потоке)
+    // Клон берется по имени соединения: перегрузка с QSqlDatabase обращается
+    // к объекту основного потока, а по имени Qt (5.13+) клонирует под своей
+    // блокировкой
+    QString name = QString("phonebook_worker_%1").arg(++m_workerCounter);
+    QSqlDatabase worker = QSqlDatabase::cloneDatabase(db.connectionName(), name);
+    if (!worker.open()) {
+        qDebug() << "Failed to open worker connection:" << worker.lastError().text();
+    }
+    m_workerConnections.insert(current, name);
+    connect(current, &QThread::finished, this, [this, current]() {
+        releaseThread(current);
+    }, Qt::DirectConnection);
+    return worker;
+}
+
+void DatabaseManager::releaseThread(QThread* thread) const
+{
+    QString name;
+    {
+        QMutexLocker locker(&m_threadsMutex);
+        m_statements.erase(thread);
+        name = m_workerConnections.take(thread);
+    }
+    disconnect(thread, &QThread::finished, this, nullptr);
+    if (!name.isEmpty()) {
+        QSqlDatabase::removeDatabase(name);
+    }
+}
 
+void DatabaseManager::invalidateStatements()
+{
+    QMutexLocker locker(&m_threadsMutex);
+    m_statements.clear();
+}
+
+bool DatabaseManager::execOrFail(QSqlQuery& query)
+{
     if (!query.exec()) {
         m_lastError = query.lastError().text();
-        rollbackTransaction();
         return false;
     }
+    return true;
+}
 
-    int contactId = query.lastInsertId().toInt();
-
-    // Добавляем телефоны
+bool DatabaseManager::insertPhones(int contactId, const Contact& contact)
+{
+    QSqlQuery& query = statement(Statement::InsertPhone);
     for (const auto& phone : contact.getPhoneNumbers()) {
-        query.prepare("INSERT INTO phone_numbers (contact_id, number, type) "
-                     "VALUES (:contact_id, :number, :type)");
-        
         query.bindValue(":contact_id", contactId);
-        query.bindValue(":number", QString::fromStdString(phone.getNumber()));
-        query.bindValue(":type", QString::fromStdString(phone.getType()));
+        query.bindValue(":number", toQString(phone.getNumber()));
+        query.bindValue(":type", toQString(phone.getType()));
+        query.bindValue(":normalized_number",
+                        QString::fromStdString(PhoneNumber::normalizeNumber(phone.getNumber())));
 
-        if (!query.exec()) {
-            m_lastError = query.lastError().text();
-            rollbackTransaction();
+        if (!execOrFail(query)) {
             return false;
         }
     }
+    return true;
+}
+
+bool DatabaseManager::insertContact(const Contact& contact, int& contactId)
+{
+    QSqlQuery& query = statement(Statement::InsertContact);
+    bindContactFields(query, contact);
+    if (!execOrFail(query)) {
+        return false;
+    }
+
+    contactId = query.lastInsertId().toInt();
+    return insertPhones(contactId, contact);
+}
+
+bool DatabaseManager::replaceContact(int id, const Contact& contact)
+{
+    QSqlQuery& query = statement(Statement::UpdateContact);
+    query.bindValue(":id", id);
+    bindContactFields(query, contact);
+    if (!execOrFail(query)) {
+        return false;
+    }
+    if (query.numRowsAffected() == 0) {
+        m_lastError = "Контакт не найден";
+        return false;
+    }
+
+    // Телефоны проще пересоздать, чем сопоставлять
+    QSqlQuery& deletePhones = statement(Statement::DeletePhones);
+    deletePhones.bindValue(":id", id);
+    if (!execOrFail(deletePhones)) {
+        return false;
+    }
+    return insertPhones(id, contact);
+}
+
+bool DatabaseManager::removeContact(int id)
+{
+    // Сначала удаляем телефоны, затем контакт
+    QSqlQuery& deletePhones = statement(Statement::DeletePhones);
+    deletePhones.bindValue(":id", id);
+    if (!execOrFail(deletePhones)) {
+        return false;
+    }
+
+    QSqlQuery& query = statement(Statement::DeleteContact);
+    query.bindValue(":id", id);
+    if (!execOrFail(query)) {
+        return false;
+    }
+    if (query.numRowsAffected() == 0) {
+        m_lastError = "Контакт не найден";
+        return false;
+    }
+    return true;
+}
+
+template<typename Item, typename Apply>
+std::vector<bool> DatabaseManager::runBatch(const std::vector<Item>& items, Apply apply)
+{
+    std::vector<bool> results(items.size(), false);
+    if (items.empty() || (!isOpen() && !open())) {
+        return results;
+    }
+    if (!beginTransaction()) {
+        m_lastError = connection().lastError().text();
+        return results;
+    }
+
+    // Каждый элемент - в своей точке сохранения: ошибка откатывает только его
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (!execOrFail(statement(Statement::Savepoint))) {
+            rollbackTransaction();
+            return std::vector<bool>(items.size(), false);
+        }
+
+        results[i] = apply(items[i], i);
+        if (!results[i]) {
+            QString error = m_lastError;
+            // Без отката точки сохранения в транзакции остались бы
+            // частичные изменения элемента - такой пакет фиксировать нельзя
+            if (!execOrFail(statement(Statement::RollbackToSavepoint))) {
+                rollbackTransaction();
+                return std::vector<bool>(items.size(), false);
+            }
+            m_lastError = error;
+        }
+        if (!execOrFail(statement(Statement::ReleaseSavepoint))) {
+            rollbackTransaction();
+            return std::vector<bool>(items.size(), false);
+        }
+    }
+
+    if (!commitTransaction()) {
+        m_lastError = connection().lastError().text();
+        rollbackTransaction();
+        return std::vector<bool>(items.size(), false);
+    }
+    return results;
+}
+
+bool DatabaseManager::addContact(const Contact& contact)
+{
+    if (!isOpen() && !open()) {
+        return false;
+    }
+
+    beginTransaction();
+
+    int contactId = -1;
+    if (!insertContact(contact, contactId)) {
+        rollbackTransaction();
+        return false;
+    }
 
     return commitTransaction();
 }
 
-std::vector<Contact> DatabaseManager::getAllContacts() const
+std::vector<bool> DatabaseManager::addContacts(std::vector<Contact>& contacts)
 {
-    std::vector<Contact> contacts;
-    
-    QSqlQuery query(db);
-    query.prepare(
-        "SELECT c.id, c.last_name, c.first_name, c.middle_name, "
-        "c.birth_date, c.address, c.email, "
-        "p.number, p.type "
-        "FROM contacts c "
-        "LEFT JOIN phone_numbers p ON c.id = p.contact_id "
-        "ORDER BY c.id"
-    );
-    
-    if (!query.exec()) {
-        qDebug() << "Failed to get contacts:" << query.lastError().text();
-        return contacts;
+    std::vector<int> ids(contacts.size(), -1);
+    std::vector<bool> results = runBatch(contacts, [&](const Contact& contact, size_t i) {
+        return insertContact(contact, ids[i]);
+    });
+
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        contacts[i].setId(results[i] ? ids[i] : -1);
     }
-    
+    return results;
+}
+
+std::vector<bool> DatabaseManager::updateContacts(const std::vector<Contact>& contacts)
+{
+    return runBatch(contacts, [this](const Contact& contact, size_t) {
+        return replaceContact(contact.getId(), contact);
+    });
+}
+
+std::vector<bool> DatabaseManager::deleteContacts(const std::vector<int>& ids)
+{
+    return runBatch(ids, [this](int id, size_t) {
+        return removeContact(id);
+    });
+}
+
+template<typename Consumer>
+bool DatabaseManager::readJoinedContacts(QSqlQuery& query, Consumer consume) const
+{
+    // Строки "контакт + телефон" идут подряд по id контакта. Все они
+    // разбираются в один и тот же Contact, который отдается потребителю
+    // целиком перед началом следующего контакта.
+    // Столбцы: 0 id, 1 last_name, 2 first_name, 3 middle_name,
+    // 4 birth_date, 5 address, 6 email, 7 number, 8 type
+    Contact contact;
+    bool haveContact = false;
     int currentId = -1;
-    std::unique_ptr<Contact> currentContact;
-    
+
     while (query.next()) {
-        int id = query.value("id").toInt();
-        
+        int id = query.value(0).toInt();
+
         // Если это новый контакт
-        if (id != currentId) {
-            // Если был предыдущий контакт, добавляем его в вектор
-            if (currentContact) {
-                contacts.push_back(*currentContact);
+        if (!haveContact || id != currentId) {
+            if (haveContact && !consume(contact)) {
+                query.finish();
+                return false;
             }
-            
-            currentContact = std::make_unique<Contact>();
+
+            haveContact = true;
             currentId = id;
-            
-            currentContact->setId(id);
-            currentContact->setLastName(query.value("last_name").toString().toStdString());
-            currentContact->setFirstName(query.value("first_name").toString().toStdString());
-            currentContact->setMiddleName(query.value("middle_name").toString().toStdString());
-            currentContact->setBirthDate(query.value("birth_date").toString().toStdString());
-            currentContact->setAddress(query.value("address").toString().toStdString());
-            currentContact->setEmail(query.value("email").toString().toStdString());
-        }
-        
+
+            // Строки базы проверялись при записи - загружаем их без валидации
+            contact = Contact::fromStorage(id,
+                                           Utf8(query.value(1).toString()),
+                                           Utf8(query.value(2).toString()),
+                                           Utf8(query.value(3).toString()),
+                                           Utf8(query.value(4).toString()),
+                                           Utf8(query.value(5).toString()),
+                                           Utf8(query.value(6).toString()));
+        }
+
         // Добавляем телефон, если он есть
-        if (!query.value("number").isNull()) {
-            PhoneNumber phone(
-                query.value("number").toString().toStdString(),
-                query.value("type").toString().toStdString()
-            );
-            currentContact->addPhoneNumber(phone);
+        if (!query.isNull(7)) {
+            contact.addStoredPhoneNumber(Utf8(query.value(7).toString()),
+                                         Utf8(query.value(8).toString()));
         }
     }
+    query.finish();
+
+    // Отдаем последний контакт
+    return !haveContact || consume(contact);
+}
+
+std::vector<Contact> DatabaseManager::getAllContacts() const
+{
+    std::vector<Contact> contacts;
     
-    // Добавляем последний контакт
-    if (currentContact) {
-        contacts.push_back(*currentContact);
+    QSqlQuery& query = statement(Statement::SelectAllContacts);
+    ++readQueryCount;
+    if (!query.exec()) {
+        qDebug() << "Failed to get contacts:" << query.lastError().text();
+        return contacts;
     }
+
+    // Готовый контакт перемещается в результат, а не копируется
+    readJoinedContacts(query, [&contacts](Contact& contact) {
+        contacts.push_back(std::move(contact));
+        return true;
+    });
     
     return contacts;
 }
 
-bool DatabaseManager::updateContact(int id, const Contact& contact)
+bool DatabaseManager::getContact(int id, Contact& contact) const
 {
-    if (!isOpen() && !open()) {
+    QSqlQuery& query = statement(Statement::SelectContact);
+    query.bindValue(":id", id);
+    ++readQueryCount;
+    if (!query.exec()) {
+        qDebug() << "Failed to get contact:" << query.lastError().text();
         return false;
     }
 
-    beginTransaction();
-
-    QSqlQuery query(db);
-    query.prepare("UPDATE contacts SET first_name=:first_name, last_name=:last_name, "
-                 "middle_name=:middle_name, birth_date=:birth_date, address=:address, "
-                 "email=:email WHERE id=:id");
-    
-    query.bindValue(":id", id);
-    query.bindValue(":first_name", QString::fromStdString(contact.getFirstName()));
-    query.bindValue(":last_name", QString::fromStdString(contact.getLastName()));
-    query.bindValue(":middle_name", QString::fromStdString(contact.getMiddleName()));
-    query.bindValue(":birth_date", QString::fromStdString(contact.getBirthDate()));
-    query.bindValue(":address", QString::fromStdString(contact.getAddress()));
-    query.bindValue(":email", QString::fromStdString(contact.getEmail()));
+    bool found = false;
+    readJoinedContacts(query, [&](Contact& row) {
+        contact = std::move(row);
+        found = true;
+        return true;
+    });
+    return found;
+}
 
+bool DatabaseManager::forEachContact(const ContactVisitor& visitor) const
+{
+    QSqlQuery& query = statement(Statement::SelectAllContacts);
+    ++readQueryCount;
     if (!query.exec()) {
-        m_lastError = query.lastError().text();
-        rollbackTransaction();
+        qDebug() << "Failed to get contacts:" << query.lastError().text();
         return false;
     }
 
-    // Удаляем старые телефоны
-    query.prepare("DELETE FROM phone_numbers WHERE contact_id=:id");
-    query.bindValue(":id", id);
-    
-    if (!query.exec()) {
-        m_lastError = query.lastError().text();
-        rollbackTransaction();
+    return readJoinedContacts(query, [&visitor](Contact& contact) {
+        return visitor(contact);
+    });
+}
+
+bool DatabaseManager::updateContact(int id, const Contact& contact)
+{
+    if (!isOpen() && !open()) {
         return false;
     }
 
-    // Добавляем новые телефоны
-    for (const auto& phone : contact.getPhoneNumbers()) {
-        query.prepare("INSERT INTO phone_numbers (contact_id, number, type) "
-                     "VALUES (:contact_id, :number, :type)");
-        
-        query.bindValue(":contact_id", id);
-        query.bindValue(":number", QString::fromStdString(phone.getNumber()));
-        query.bindValue(":type", QString::fromStdString(phone.getType()));
+    beginTransaction();
 
-        if (!query.exec()) {
-            m_lastError = query.lastError().text();
-            rollbackTransaction();
-            return false;
-        }
+    if (!replaceContact(id, contact)) {
+        rollbackTransaction();
+        return false;
     }
 
     return commitTransaction();
@@ -259,97 +622,445 @@ bool DatabaseManager::deleteContact(int id)
 
     beginTransaction();
 
-    QSqlQuery query(db);
-    
-    // Сначала удаляем телефоны
-    query.prepare("DELETE FROM phone_numbers WHERE contact_id=:id");
-    query.bindValue(":id", id);
-    
-    if (!query.exec()) {
-        m_lastError = query.lastError().text();
+    if (!removeContact(id)) {
         rollbackTransaction();
         return false;
     }
 
-    // Затем удаляем контакт
-    query.prepare("DELETE FROM contacts WHERE id=:id");
-    query.bindValue(":id", id);
-    
-    if (!query.exec()) {
-        m_lastError = query.lastError().text();
-        rollbackTransaction();
-        return false;
+    return commitTransaction();
+}
+
+QSqlQuery* DatabaseManager::execSearch(const QString& pattern, bool& matchesAll) const
+{
+    matchesAll = false;
+
+    // Строку из цифр и символов номера дополнительно ищем как часть номера.
+    // Префиксный поиск по номеру (searchByPhone) общий поиск не заменяет:
+    // цифры адреса, email и середины номера тоже должны находиться
+    bool phoneLike = looksLikePhoneNumber(pattern);
+    QSqlQuery* query = nullptr;
+    if (m_hasFullTextIndex) {
+        QString ftsQuery = fullTextQuery(pattern);
+        if (ftsQuery.isEmpty()) {
+            matchesAll = true;
+            return nullptr;
+        }
+        query = &statement(phoneLike ? Statement::FindContactsFtsOrPhone : Statement::FindContactsFts);
+        query->bindValue(":query", ftsQuery);
+    } else {
+        if (pattern.trimmed().isEmpty()) {
+            matchesAll = true;
+            return nullptr;
+        }
+        query = &statement(phoneLike ? Statement::FindContactsOrPhone : Statement::FindContacts);
+        query->bindValue(":pattern", "%" + pattern + "%");
+    }
+    if (phoneLike) {
+        query->bindValue(":digits", "%" + phoneDigits(pattern) + "%");
     }
 
-    return commitTransaction();
+    ++readQueryCount;
+    if (!query->exec()) {
+        qDebug() << "Search failed:" << query->lastError().text();
+        return nullptr;
+    }
+    return query;
 }
 
 std::vector<Contact> DatabaseManager::findContacts(const QString& pattern) const
 {
-    std::vector<Contact> results;
-    
     if (!db.isOpen()) {
-        return results;
+        return {};
     }
 
-    QSqlQuery query(db);
-    query.prepare("SELECT DISTINCT c.id, c.first_name, c.last_name, c.email "
-                 "FROM contacts c "
-                 "LEFT JOIN phone_numbers p ON c.id = p.contact_id "
-                 "WHERE c.first_name LIKE :pattern "
-                 "OR c.last_name LIKE :pattern "
-                 "OR c.email LIKE :pattern "
-                 "OR p.number LIKE :pattern");
-    
-    query.bindValue(":pattern", "%" + pattern + "%");
+    bool matchesAll = false;
+    QSqlQuery* query = execSearch(pattern, matchesAll);
+    if (matchesAll) {
+        return getAllContacts();
+    }
+    if (!query) {
+        return {};
+    }
 
+    return readSearchResults(*query);
+}
+
+bool DatabaseManager::forEachMatch(const QString& pattern, const ContactVisitor& visitor) const
+{
+    if (!db.isOpen()) {
+        return false;
+    }
+
+    bool matchesAll = false;
+    QSqlQuery* query = execSearch(pattern, matchesAll);
+    if (matchesAll) {
+        return forEachContact(visitor);
+    }
+    if (!query) {
+        return false;
+    }
+
+    return readSearchRows(*query, [&visitor](Contact& contact) {
+        return visitor(contact);
+    });
+}
+
+std::vector<std::string> DatabaseManager::completeLastName(const QString& prefix, int limit) const
+{
+    std::vector<std::string> names;
+    if (!db.isOpen() || limit <= 0) {
+        return names;
+    }
+
+    QString key = QString::fromStdString(SearchIndex::fold(prefix));
+    QSqlQuery& query = statement(Statement::CompleteLastName);
+    query.bindValue(":from", key);
+    query.bindValue(":to", prefixUpperBound(key));
+    query.bindValue(":limit", limit);
+    ++readQueryCount;
     if (!query.exec()) {
-        qDebug() << "Search failed:" << query.lastError().text();
-        return results;
+        qDebug() << "Last name completion failed:" << query.lastError().text();
+        return names;
     }
 
     while (query.next()) {
-        Contact contact = contactFromQuery(query);
-        if (!loadPhoneNumbers(contact)) {
-            qDebug() << "Failed to load phone numbers for contact" << contact.getId();
-            continue;
+        names.push_back(query.value(0).toString().toStdString());
+    }
+    query.finish();
+    return names;
+}
+
+std::vector<Contact> DatabaseManager::findByLastNamePrefix(const QString& prefix, int limit) const
+{
+    if (!db.isOpen() || limit <= 0) {
+        return {};
+    }
+
+    QString key = QString::fromStdString(SearchIndex::fold(prefix));
+    QSqlQuery& query = statement(Statement::FindByLastNamePrefix);
+    query.bindValue(":from", key);
+    query.bindValue(":to", prefixUpperBound(key));
+    query.bindValue(":limit", limit);
+    ++readQueryCount;
+    if (!query.exec()) {
+        qDebug() << "Last name prefix search failed:" << query.lastError().text();
+        return {};
+    }
+    return readSearchResults(query);
+}
+
+std::vector<Contact> DatabaseManager::getContactsPage(const ContactPageKey& after, int limit) const
+{
+    if (!db.isOpen() || limit <= 0) {
+        return {};
+    }
+
+    QSqlQuery& query = statement(Statement::SelectContactsPage);
+    query.bindValue(":last_name", QString::fromStdString(after.lastName));
+    query.bindValue(":id", after.id);
+    query.bindValue(":limit", limit);
+
+    ++readQueryCount;
+    if (!query.exec()) {
+        qDebug() << "Failed to get contacts page:" << query.lastError().text();
+        return {};
+    }
+
+    return readSearchResults(query);
+}
+
+bool DatabaseManager::looksLikePhoneNumber(const QString& pattern)
+{
+    int digits = 0;
+    for (QChar c : pattern) {
+        if (c.isDigit()) {
+            ++digits;
+        } else if (c != '+' && c != '(' && c != ')' && c != '-' && !c.isSpace()) {
+            return false;
         }
-        results.push_back(contact);
     }
+    return digits >= 3;
+}
 
-    return results;
+QString DatabaseManager::phoneDigits(const QString& pattern)
+{
+    // Цифры вне ASCII - по значению, как в normalizeNumber
+    QString digits;
+    for (QChar c : pattern) {
+        if (c.isDigit()) {
+            digits += QChar('0' + c.digitValue());
+        }
+    }
+    return digits;
 }
 
-Contact DatabaseManager::contactFromQuery(const QSqlQuery& query) const
+QString DatabaseManager::phoneSearchKey(const QString& pattern)
 {
-    Contact contact;
-    contact.setId(query.value("id").toInt());
-    contact.setFirstName(query.value("first_name").toString().toStdString());
-    contact.setLastName(query.value("last_name").toString().toStdString());
-    contact.setMiddleName(query.value("middle_name").toString().toStdString());
-    contact.setBirthDate(query.value("birth_date").toString().toStdString());
-    contact.setAddress(query.value("address").toString().toStdString());
-    contact.setEmail(query.value("email").toString().toStdString());
-    return contact;
+    // Запрос приводим к тому же виду, что и normalized_number (+7XXXXXXXXXX),
+    // код страны дописываем сами. Ведущая 8 - выход на межгород (как в
+    // normalizeNumber) только у полного номера из 11 цифр или если за ней
+    // идет разделитель: "8 (812)", "8-812". Иначе это начало кода города:
+    // "812" ищется как "+7812", а не как "+712"
+    QString text = pattern.trimmed();
+    QString number;
+    int digits = 0;
+    bool trunkPrefix = false;
+    for (int i = 0; i < text.size(); ++i) {
+        QChar c = text.at(i);
+        if (c.isDigit()) {
+            if (number.isEmpty() && c == '8') {
+                trunkPrefix = i + 1 < text.size() && !text.at(i + 1).isDigit();
+            }
+            number += c;
+            ++digits;
+        } else if (c == '+') {
+            number += c;
+        }
+    }
+
+    if (number.isEmpty() || number.startsWith('+')) {
+        return number;
+    }
+    if (number.startsWith('8') && (trunkPrefix || digits == 11)) {
+        return "+7" + number.mid(1);
+    }
+    return (number.startsWith('7') ? "+" : "+7") + number;
 }
 
-bool DatabaseManager::loadPhoneNumbers(Contact& contact) const
+QSqlQuery* DatabaseManager::execPhoneSearch(const std::string& phoneNumber, bool prefixMatch) const
 {
-    QSqlQuery query(db);
-    query.prepare("SELECT number, type FROM phone_numbers WHERE contact_id=:id");
-    query.bindValue(":id", contact.getId());
+    QString number = phoneSearchKey(QString::fromStdString(phoneNumber));
+    if (number.isEmpty()) {
+        return nullptr;
+    }
 
-    if (!query.exec()) {
-        qDebug() << "Failed to load phone numbers:" << query.lastError().text();
+    QSqlQuery* query = nullptr;
+    if (prefixMatch) {
+        // Диапазон [префикс, префикс с увеличенным последним символом)
+        // использует индекс idx_phone_numbers_normalized
+        QString upper = number;
+        upper[upper.size() - 1] = QChar(upper.at(upper.size() - 1).unicode() + 1);
+        query = &statement(Statement::FindByPhonePrefix);
+        query->bindValue(":from", number);
+        query->bindValue(":to", upper);
+    } else {
+        query = &statement(Statement::FindByPhone);
+        query->bindValue(":number", number);
+    }
+
+    ++readQueryCount;
+    if (!query->exec()) {
+        qDebug() << "Phone search failed:" << query->lastError().text();
+        return nullptr;
+    }
+    return query;
+}
+
+std::vector<Contact> DatabaseManager::searchByPhone(const std::string& phoneNumber, bool prefixMatch) const
+{
+    if (!db.isOpen()) {
+        return {};
+    }
+
+    QSqlQuery* query = execPhoneSearch(phoneNumber, prefixMatch);
+    if (!query) {
+        return {};
+    }
+    return readSearchResults(*query);
+}
+
+QStringList DatabaseManager::searchTerms(const QString& text)
+{
+    // Слова - как их выделяет токенизатор unicode61: непрерывные буквы и цифры
+    QStringList terms;
+    QString term;
+    for (QChar c : text) {
+        if (c.isLetterOrNumber()) {
+            term += c;
+        } else if (!term.isEmpty()) {
+            terms << term;
+            term.clear();
+        }
+    }
+    if (!term.isEmpty()) {
+        terms << term;
+    }
+    return terms;
+}
+
+QString DatabaseManager::fullTextQuery(const QString& pattern)
+{
+    // Каждое слово ищется как префикс токена,
+    // все слова должны встретиться (неявный AND)
+    QStringList terms;
+    for (const QString& term : searchTerms(pattern)) {
+        terms << "\"" + term + "\"*";
+    }
+    return terms.join(' ');
+}
+
+QString DatabaseManager::foldSearchTerm(const QString& term)
+{
+    // Как unicode61 с remove_diacritics 2: простая свертка регистра
+    // (ς -> σ, ſ -> s) и снятие диакритики только с букв ASCII (é -> e).
+    // Кириллица не меняется: ё и е - разные токены и в contacts_fts
+    QString folded;
+    for (QChar c : term.toCaseFolded().normalized(QString::NormalizationForm_D)) {
+        if (c.category() == QChar::Mark_NonSpacing && !folded.isEmpty()) {
+            QChar base = folded.at(folded.size() - 1);
+            if (base.unicode() < 0x80 && base.isLetter()) {
+                continue;
+            }
+        }
+        folded += c;
+    }
+    return folded.normalized(QString::NormalizationForm_C);
+}
+
+bool DatabaseManager::matchesQuery(const Contact& contact, const QString& pattern) const
+{
+    if (looksLikePhoneNumber(pattern)) {
+        // Та же проверка, что и в execSearch: цифры запроса - часть
+        // нормализованного номера
+        QString digits = phoneDigits(pattern);
+        for (const auto& phone : contact.getPhoneNumbers()) {
+            if (QString::fromStdString(PhoneNumber::normalizeNumber(phone.getNumber())).contains(digits)) {
+                return true;
+            }
+        }
+    }
+
+    QStringList terms = searchTerms(pattern);
+    if (terms.isEmpty()) {
+        return true;
+    }
+
+    // Те же столбцы, что попадают в contacts_fts (см. createSearchIndex)
+    QString text = toQString(contact.getLastName()) + ' ' +
+                   toQString(contact.getFirstName()) + ' ' +
+                   toQString(contact.getMiddleName()) + ' ' +
+                   toQString(contact.getEmail()) + ' ' +
+                   toQString(contact.getAddress());
+    for (const auto& phone : contact.getPhoneNumbers()) {
+        QString number = toQString(phone.getNumber());
+        QString digits = number;
+        digits.remove(QRegExp("[+()\\- ]"));
+        text += ' ' + number + ' ' + digits;
+    }
+
+    QStringList tokens;
+    for (const QString& token : searchTerms(text)) {
+        tokens << foldSearchTerm(token);
+    }
+    for (const QString& term : terms) {
+        QString folded = foldSearchTerm(term);
+        bool found = std::any_of(tokens.begin(), tokens.end(),
+            [&folded](const QString& token) { return token.startsWith(folded); });
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DatabaseManager::narrows(const QString& previous, const QString& pattern) const
+{
+    // Правила LIKE (регистр только для ASCII) здесь не воспроизводятся
+    if (!m_hasFullTextIndex || !pattern.startsWith(previous)) {
         return false;
     }
 
+    // Дописанный запрос сужает и слова, и цифры номера. Но если цифры
+    // номера ищутся только в новом запросе, прежний результат их не учитывал
+    return looksLikePhoneNumber(previous) || !looksLikePhoneNumber(pattern);
+}
+
+Contact DatabaseManager::contactFromQuery(const QSqlQuery& query) const
+{
+    return Contact::fromStorage(query.value("id").toInt(),
+                                Utf8(query.value("last_name").toString()),
+                                Utf8(query.value("first_name").toString()),
+                                Utf8(query.value("middle_name").toString()),
+                                Utf8(query.value("birth_date").toString()),
+                                Utf8(query.value("address").toString()),
+                                Utf8(query.value("email").toString()));
+}
+
+template<typename Consumer>
+bool DatabaseManager::readSearchRows(QSqlQuery& query, Consumer consume) const
+{
+    // Контакты читаются пачками по kPhoneBatchSize: телефоны пачки
+    // подтягиваются одним запросом, а не отдельным запросом на каждый контакт
+    std::vector<Contact> chunk;
+    chunk.reserve(kPhoneBatchSize);
+
+    auto flushChunk = [&]() {
+        if (!attachPhoneNumbers(chunk)) {
+            qDebug() << "Failed to load phone numbers for search results";
+        }
+        for (auto& contact : chunk) {
+            if (!consume(contact)) {
+                return false;
+            }
+        }
+        chunk.clear();
+        return true;
+    };
+
     while (query.next()) {
-        PhoneNumber phone(
-            query.value("number").toString().toStdString(),
-            query.value("type").toString().toStdString()
-        );
-        contact.addPhoneNumber(phone);
+        chunk.push_back(contactFromQuery(query));
+        if (int(chunk.size()) == kPhoneBatchSize && !flushChunk()) {
+            query.finish();
+            return false;
+        }
+    }
+    query.finish();
+
+    return flushChunk();
+}
+
+std::vector<Contact> DatabaseManager::readSearchResults(QSqlQuery& query) const
+{
+    std::vector<Contact> results;
+    readSearchRows(query, [&results](Contact& contact) {
+        results.push_back(std::move(contact));
+        return true;
+    });
+    return results;
+}
+
+bool DatabaseManager::attachPhoneNumbers(std::vector<Contact>& contacts) const
+{
+    std::unordered_map<int, size_t> positions;
+    positions.reserve(contacts.size());
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        positions[contacts[i].getId()] = i;
+    }
+
+    QSqlQuery& query = statement(Statement::SelectPhonesBatch);
+    for (size_t start = 0; start < contacts.size(); start += kPhoneBatchSize) {
+        // Неполная пачка добивается несуществующим id, чтобы использовать
+        // один и тот же подготовленный запрос
+        for (int i = 0; i < kPhoneBatchSize; ++i) {
+            size_t index = start + size_t(i);
+            query.bindValue(i, index < contacts.size() ? contacts[index].getId() : -1);
+        }
+
+        ++readQueryCount;
+        if (!query.exec()) {
+            qDebug() << "Failed to load phone numbers:" << query.lastError().text();
+            return false;
+        }
+
+        while (query.next()) {
+            auto it = positions.find(query.value(0).toInt());
+            if (it == positions.end()) {
+                continue;
+            }
+            contacts[it->second].addStoredPhoneNumber(Utf8(query.value(1).toString()),
+                                                      Utf8(query.value(2).toString()));
+        }
+        query.finish();
     }
 
     return true;
@@ -365,7 +1076,8 @@ bool DatabaseManager::createTables()
         "middle_name TEXT,"
         "birth_date TEXT,"
         "address TEXT,"
-        "email TEXT"
+        "email TEXT,"
+        "last_name_key TEXT"
         ")",
 
         "CREATE TABLE IF NOT EXISTS phone_numbers ("
@@ -373,6 +1085,7 @@ bool DatabaseManager::createTables()
         "contact_id INTEGER NOT NULL,"
         "number TEXT NOT NULL,"
         "type TEXT NOT NULL,"
+        "normalized_number TEXT,"
         "FOREIGN KEY(contact_id) REFERENCES contacts(id)"
         ")"
     };
@@ -392,7 +1105,10 @@ bool DatabaseManager::createIndexes()
 {
     QStringList queries = {
         "CREATE INDEX IF NOT EXISTS idx_contacts_name ON contacts(first_name, last_name)",
-        "CREATE INDEX IF NOT EXISTS idx_phone_numbers_contact ON phone_numbers(contact_id)"
+        "CREATE INDEX IF NOT EXISTS idx_contacts_last_name ON contacts(last_name, id)",
+        "CREATE INDEX IF NOT EXISTS idx_contacts_last_name_key ON contacts(last_name_key, id)",
+        "CREATE INDEX IF NOT EXISTS idx_phone_numbers_contact ON phone_numbers(contact_id)",
+        "CREATE INDEX IF NOT EXISTS idx_phone_numbers_normalized ON phone_numbers(normalized_number)"
     };
 
     for (const QString& queryStr : queries) {
@@ -406,6 +1122,190 @@ bool DatabaseManager::createIndexes()
     return true;
 }
 
+int DatabaseManager::schemaVersion()
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA user_version") || !query.next()) {
+        return 0;
+    }
+    return query.value(0).toInt();
+}
+
+bool DatabaseManager::hasColumn(const QString& table, const QString& column)
+{
+    QSqlQuery query(db);
+    if (!query.exec("PRAGMA table_info(" + table + ")")) {
+        return false;
+    }
+    while (query.next()) {
+        if (query.value("name").toString() == column) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DatabaseManager::migrateSchema()
+{
+    int version = schemaVersion();
+    if (version >= kSchemaVersion) {
+        return true;
+    }
+
+    beginTransaction();
+    QSqlQuery query(db);
+
+    // Версия 1: нормализованный номер для поиска по телефону
+    if (version < 1) {
+        if (!hasColumn("phone_numbers", "normalized_number") &&
+            !query.exec("ALTER TABLE phone_numbers ADD COLUMN normalized_number TEXT")) {
+            m_lastError = query.lastError().text();
+            rollbackTransaction();
+            return false;
+        }
+
+        // Нормализация написана на C++, поэтому заполняем столбец построчно
+        QSqlQuery select(db);
+        QSqlQuery update(db);
+        update.prepare("UPDATE phone_numbers SET normalized_number = :normalized WHERE id = :id");
+        if (!select.exec("SELECT id, number FROM phone_numbers WHERE normalized_number IS NULL")) {
+            m_lastError = select.lastError().text();
+            rollbackTransaction();
+            return false;
+        }
+        while (select.next()) {
+            update.bindValue(":normalized", QString::fromStdString(
+                PhoneNumber::normalizeNumber(select.value("number").toString().toStdString())));
+            update.bindValue(":id", select.value("id"));
+            if (!update.exec()) {
+                m_lastError = update.lastError().text();
+                rollbackTransaction();
+                return false;
+            }
+        }
+    }
+
+    // Версия 2: ключ фамилии для автодополнения (SearchIndex::fold)
+    if (version < 2) {
+        if (!hasColumn("contacts", "last_name_key") &&
+            !query.exec("ALTER TABLE contacts ADD COLUMN last_name_key TEXT")) {
+            m_lastError = query.lastError().text();
+            rollbackTransaction();
+            return false;
+        }
+
+        QSqlQuery select(db);
+        QSqlQuery update(db);
+        update.prepare("UPDATE contacts SET last_name_key = :key WHERE id = :id");
+        if (!select.exec("SELECT id, last_name FROM contacts WHERE last_name_key IS NULL")) {
+            m_lastError = select.lastError().text();
+            rollbackTransaction();
+            return false;
+        }
+        while (select.next()) {
+            update.bindValue(":key", QString::fromStdString(
+                SearchIndex::fold(select.value("last_name").toString())));
+            update.bindValue(":id", select.value("id"));
+            if (!update.exec()) {
+                m_lastError = update.lastError().text();
+                rollbackTransaction();
+                return false;
+            }
+        }
+    }
+
+    if (!query.exec(QString("PRAGMA user_version = %1").arg(kSchemaVersion))) {
+        m_lastError = query.lastError().text();
+        rollbackTransaction();
+        return false;
+    }
+
+    return commitTransaction();
+}
+
+bool DatabaseManager::createSearchIndex()
+{
+    // Телефон индексируется и как есть, и одними цифрами:
+    // "+7(812)123-45-67" дает токены 7, 812, 123, 45, 67 и 78121234567
+    const QString phonesExpr = QStringLiteral(
+        "(SELECT group_concat(number || ' ' || "
+        "replace(replace(replace(replace(replace(number, '+', ''), '(', ''), ')', ''), '-', ''), ' ', ''), "
+        "' ') FROM phone_numbers WHERE contact_id = %1)");
+
+    const QStringList triggers = {
+        "CREATE TRIGGER IF NOT EXISTS contacts_fts_insert AFTER INSERT ON contacts BEGIN "
+        "INSERT INTO contacts_fts(rowid, last_name, first_name, middle_name, email, address, phones) "
+        "VALUES (new.id, new.last_name, new.first_name, new.middle_name, new.email, new.address, ''); "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS contacts_fts_update AFTER UPDATE ON contacts BEGIN "
+        "UPDATE contacts_fts SET last_name = new.last_name, first_name = new.first_name, "
+        "middle_name = new.middle_name, email = new.email, address = new.address "
+        "WHERE rowid = old.id; "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS contacts_fts_delete AFTER DELETE ON contacts BEGIN "
+        "DELETE FROM contacts_fts WHERE rowid = old.id; "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS phone_numbers_fts_insert AFTER INSERT ON phone_numbers BEGIN "
+        "UPDATE contacts_fts SET phones = " + phonesExpr.arg("new.contact_id") +
+        " WHERE rowid = new.contact_id; "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS phone_numbers_fts_update AFTER UPDATE ON phone_numbers BEGIN "
+        "UPDATE contacts_fts SET phones = " + phonesExpr.arg("old.contact_id") +
+        " WHERE rowid = old.contact_id; "
+        "UPDATE contacts_fts SET phones = " + phonesExpr.arg("new.contact_id") +
+        " WHERE rowid = new.contact_id; "
+        "END",
+
+        "CREATE TRIGGER IF NOT EXISTS phone_numbers_fts_delete AFTER DELETE ON phone_numbers BEGIN "
+        "UPDATE contacts_fts SET phones = " + phonesExpr.arg("old.contact_id") +
+        " WHERE rowid = old.contact_id; "
+        "END"
+    };
+
+    QSqlQuery query(db);
+    bool exists = query.exec("SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'contacts_fts'") &&
+                  query.next();
+    query.finish();
+
+    beginTransaction();
+
+    if (!exists) {
+        // Таблица хранит свою копию полей: телефоны лежат в другой таблице,
+        // поэтому external content на contacts здесь не подходит
+        if (!query.exec("CREATE VIRTUAL TABLE contacts_fts USING fts5("
+                        "last_name, first_name, middle_name, email, address, phones, "
+                        "tokenize = 'unicode61 remove_diacritics 2')")) {
+            qDebug() << "Full-text search is unavailable:" << query.lastError().text();
+            rollbackTransaction();
+            return false;
+        }
+
+        // Заполняем индекс для уже существующей базы
+        if (!query.exec("INSERT INTO contacts_fts(rowid, last_name, first_name, middle_name, "
+                        "email, address, phones) "
+                        "SELECT c.id, c.last_name, c.first_name, c.middle_name, c.email, c.address, " +
+                        phonesExpr.arg("c.id") + " FROM contacts c")) {
+            qDebug() << "Failed to fill full-text index:" << query.lastError().text();
+            rollbackTransaction();
+            return false;
+        }
+    }
+
+    for (const QString& queryStr : triggers) {
+        if (!query.exec(queryStr)) {
+            qDebug() << "Failed to create full-text trigger:" << query.lastError().text();
+            rollbackTransaction();
+            return false;
+        }
+    }
+
+    return commitTransaction();
+}
+
 bool DatabaseManager::clearAllContacts()
 {
     if (!isOpen() && !open()) {
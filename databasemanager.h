@@ -10,10 +10,21 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <vector>
+#include <atomic>
+#include <unordered_map>
 #include <QMap>
+#include <QHash>
+#include <QMutex>
 #include "contact.h"
 #include "phonenumber.h"
+#include "istorage.h"
 
+class QThread;
+
+// Менеджер базы SQLite. Основное соединение принадлежит потоку, создавшему
+// объект; при вызове из другого потока (фоновый поиск) открывается клон
+// соединения для этого потока. Сами вызовы должны быть сериализованы
+// вызывающей стороной (PhoneBook делает это мьютексом).
 class DatabaseManager : public QObject
 {
     Q_OBJECT
@@ -35,24 +46,112 @@ public:
     bool addContact(const Contact& contact);
     bool updateContact(int id, const Contact& contact);
     bool deleteContact(int id);
+    std::vector<bool> addContacts(std::vector<Contact>& contacts);
+    std::vector<bool> updateContacts(const std::vector<Contact>& contacts);
+    std::vector<bool> deleteContacts(const std::vector<int>& ids);
+    bool getContact(int id, Contact& contact) const;
     std::vector<Contact> getAllContacts() const;
     std::vector<Contact> findContacts(const QString& pattern) const;
+    // Потоковый обход без сборки вектора; visitor возвращает false, чтобы остановиться
+    bool forEachContact(const ContactVisitor& visitor) const;
+    bool forEachMatch(const QString& pattern, const ContactVisitor& visitor) const;
+    std::vector<Contact> getContactsPage(const ContactPageKey& after, int limit) const;
+    // Автодополнение фамилии по столбцу last_name_key (SearchIndex::fold)
+    std::vector<std::string> completeLastName(const QString& prefix, int limit) const;
+    std::vector<Contact> findByLastNamePrefix(const QString& prefix, int limit) const;
+    // Проверка одного контакта по правилам forEachMatch (без обращения к базе)
+    bool matchesQuery(const Contact& contact, const QString& pattern) const;
+    bool narrows(const QString& previous, const QString& pattern) const;
+    // Поиск по номеру телефона: точное совпадение или префикс нормализованного номера
+    std::vector<Contact> searchByPhone(const std::string& phoneNumber, bool prefixMatch = false) const;
     bool clearAllContacts();
     bool testConnection();
     QString getLastError() const { return m_lastError; }
 
+    // Число выполненных запросов чтения, для замеров
+    static int getReadQueryCount() { return readQueryCount.load(); }
+    static void resetReadQueryCount() { readQueryCount.store(0); }
+
 private:
     QString dbPath;
     QSqlDatabase db;
     QString m_lastError;
+    bool m_hasFullTextIndex = false;
+    inline static std::atomic<int> readQueryCount{0};
     
     bool executeQuery(QSqlQuery& query, const QString& queryStr);
     bool executePreparedQuery(QSqlQuery& query, const QString& queryStr, 
                             const QMap<QString, QVariant>& params);
+    // Идентификаторы подготовленных запросов
+    enum class Statement {
+        InsertContact,
+        UpdateContact,
+        DeleteContact,
+        InsertPhone,
+        DeletePhones,
+        SelectPhonesBatch,
+        SelectAllContacts,
+        SelectContact,
+        FindContacts,
+        FindContactsFts,
+        FindContactsOrPhone,
+        FindContactsFtsOrPhone,
+        FindByPhone,
+        FindByPhonePrefix,
+        SelectContactsPage,
+        CompleteLastName,
+        FindByLastNamePrefix,
+        Savepoint,
+        RollbackToSavepoint,
+        ReleaseSavepoint
+    };
+
+    // Кэш подготовленных запросов; у каждого потока свое соединение,
+    // поэтому и запросы кэшируются отдельно для каждого потока
+    using StatementCache = std::unordered_map<Statement, QSqlQuery>;
+    mutable std::unordered_map<QThread*, StatementCache> m_statements;
+    // Соединения фоновых потоков (клоны db): удаляются по QThread::finished
+    // или в close()
+    mutable QHash<QThread*, QString> m_workerConnections;
+    mutable int m_workerCounter = 0;
+    // Защищает оба кэша: finished приходит из завершающегося потока
+    mutable QMutex m_threadsMutex;
+
+    static const char* statementSql(Statement id);
+    QSqlQuery& statement(Statement id) const;
+    QSqlDatabase connection() const;
+    void releaseThread(QThread* thread) const;
+    void invalidateStatements();
+
+    bool execOrFail(QSqlQuery& query);
+    bool insertPhones(int contactId, const Contact& contact);
+    bool insertContact(const Contact& contact, int& contactId);
+    bool replaceContact(int id, const Contact& contact);
+    bool removeContact(int id);
+    template<typename Item, typename Apply>
+    std::vector<bool> runBatch(const std::vector<Item>& items, Apply apply);
     bool createTables();
     bool createIndexes();
+    bool createSearchIndex();
+    bool migrateSchema();
+    int schemaVersion();
+    bool hasColumn(const QString& table, const QString& column);
+    static bool looksLikePhoneNumber(const QString& pattern);
+    // Номер из запроса в виде normalized_number для searchByPhone
+    static QString phoneSearchKey(const QString& pattern);
+    // Цифры запроса для поиска подстроки в normalized_number
+    static QString phoneDigits(const QString& pattern);
+    static QString fullTextQuery(const QString& pattern);
+    static QStringList searchTerms(const QString& text);
+    static QString foldSearchTerm(const QString& term);
     Contact contactFromQuery(const QSqlQuery& query) const;
-    bool loadPhoneNumbers(Contact& contact) const;
+    QSqlQuery* execSearch(const QString& pattern, bool& matchesAll) const;
+    QSqlQuery* execPhoneSearch(const std::string& phoneNumber, bool prefixMatch) const;
+    template<typename Consumer>
+    bool readJoinedContacts(QSqlQuery& query, Consumer consume) const;
+    template<typename Consumer>
+    bool readSearchRows(QSqlQuery& query, Consumer consume) const;
+    std::vector<Contact> readSearchResults(QSqlQuery& query) const;
+    bool attachPhoneNumbers(std::vector<Contact>& contacts) const;
     bool getPhoneNumbers(int contactId, std::vector<PhoneNumber>& phones);
-    std::vector<Contact> searchByPhone(const std::string& phoneNumber);
 };
\ No newline at end of file
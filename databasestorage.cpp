@@ -17,6 +17,22 @@ bool DatabaseStorage::deleteContact(int id) {
     return db->deleteContact(id);
 }
 
+std::vector<bool> DatabaseStorage::addContacts(std::vector<Contact>& contacts) {
+    return db->addContacts(contacts);
+}
+
+std::vector<bool> DatabaseStorage::updateContacts(const std::vector<Contact>& contacts) {
+    return db->updateContacts(contacts);
+}
+
+std::vector<bool> DatabaseStorage::deleteContacts(const std::vector<int>& ids) {
+    return db->deleteContacts(ids);
+}
+
+bool DatabaseStorage::getContact(int id, Contact& contact) const {
+    return db->getContact(id, contact);
+}
+
 std::vector<Contact> DatabaseStorage::getAllContacts() const {
     return db->getAllContacts();
 }
@@ -25,6 +41,34 @@ std::vector<Contact> DatabaseStorage::findContacts(const QString& query) const {
     return db->findContacts(query);
 }
 
+std::vector<Contact> DatabaseStorage::getContactsPage(const ContactPageKey& after, int limit) const {
+    return db->getContactsPage(after, limit);
+}
+
+bool DatabaseStorage::forEachContact(const ContactVisitor& visitor) const {
+    return db->forEachContact(visitor);
+}
+
+bool DatabaseStorage::forEachMatch(const QString& query, const ContactVisitor& visitor) const {
+    return db->forEachMatch(query, visitor);
+}
+
+std::vector<std::string> DatabaseStorage::completeLastName(const QString& prefix, int limit) const {
+    return db->completeLastName(prefix, limit);
+}
+
+std::vector<Contact> DatabaseStorage::findByLastNamePrefix(const QString& prefix, int limit) const {
+    return db->findByLastNamePrefix(prefix, limit);
+}
+
+bool DatabaseStorage::matchesQuery(const Contact& contact, const QString& query) const {
+    return db->matchesQuery(contact, query);
+}
+
+bool DatabaseStorage::narrows(const QString& previous, const QString& query) const {
+    return db->narrows(previous, query);
+}
+
 QString DatabaseStorage::getLastError() const {
     return db->getLastError();
 } 
\ No newline at end of file
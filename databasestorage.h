@@ -9,8 +9,19 @@ public:
     bool addContact(const Contact& contact) override;
     bool updateContact(int id, const Contact& contact) override;
     bool deleteContact(int id) override;
+    std::vector<bool> addContacts(std::vector<Contact>& contacts) override;
+    std::vector<bool> updateContacts(const std::vector<Contact>& contacts) override;
+    std::vector<bool> deleteContacts(const std::vector<int>& ids) override;
+    bool getContact(int id, Contact& contact) const override;
     std::vector<Contact> getAllContacts() const override;
     std::vector<Contact> findContacts(const QString& query) const override;
+    std::vector<Contact> getContactsPage(const ContactPageKey& after, int limit) const override;
+    bool forEachContact(const ContactVisitor& visitor) const override;
+    bool forEachMatch(const QString& query, const ContactVisitor& visitor) const override;
+    std::vector<std::string> completeLastName(const QString& prefix, int limit) const override;
+    std::vector<Contact> findByLastNamePrefix(const QString& prefix, int limit) const override;
+    bool matchesQuery(const Contact& contact, const QString& query) const override;
+    bool narrows(const QString& previous, const QString& query) const override;
     QString getLastError() const override;
 
 private:
@@ -1,127 +1,552 @@
 #include "filestorage.h"
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <QJsonParseError>
+#include <QtConcurrent>
+#include <QDebug>
+
+namespace {
+// Журнал сворачивается, когда он больше половины снимка, но не раньше 1 МБ:
+// так запись остается O(размер записи) в среднем
+constexpr qint64 kMinCompactionThreshold = 1024 * 1024;
+}
 
 FileStorage::FileStorage(const QString& filePath) 
-    : m_filePath(filePath), m_nextId(1)
+    : m_filePath(filePath)
+    , m_journalPath(filePath + ".journal")
+    , m_oldJournalPath(filePath + ".journal.old")
+    , m_nextId(1)
+    , m_loaded(false)
+    , m_journalBroken(false)
+    , m_snapshotSize(0)
+    , m_journalSize(0)
+    , m_compacting(false)
 {
-    // Загружаем существующие контакты для определения следующего ID
-    std::vector<Contact> contacts;
-    if (loadContacts(contacts)) {
-        for (const auto& contact : contacts) {
-            if (contact.getId() >= m_nextId) {
-                m_nextId = contact.getId() + 1;
-            }
+    // Читаем снимок один раз, дальше работаем с копией в памяти
+    m_loaded = loadContacts(m_contacts);
+    if (!m_loaded) {
+        return;
+    }
+    m_snapshotSize = QFileInfo(m_filePath).size();
+    rebuildSlots();
+    for (const auto& contact : m_contacts) {
+        if (contact.getId() >= m_nextId) {
+            m_nextId = contact.getId() + 1;
         }
     }
+
+    // Накатываем журналы: сначала недосвернутый, затем текущий
+    m_loaded = replayJournal(m_oldJournalPath) && replayJournal(m_journalPath);
+    m_journalSize = QFileInfo(m_journalPath).size();
+    maybeCompact();
+}
+
+FileStorage::~FileStorage()
+{
+    // Журнал не сворачиваем: он будет накатан при следующем открытии
+    finishCompaction(true);
+    m_journal.close();
+}
+
+bool FileStorage::checkLoaded() {
+    // Если файл не удалось прочитать, не даем затереть его при записи
+    if (!m_loaded) {
+        m_lastError = "Файл контактов не загружен";
+        return false;
+    }
+    // Новая запись легла бы за оборванной строкой и потерялась бы при накате
+    if (m_journalBroken) {
+        m_lastError = "Журнал поврежден после ошибки записи";
+        return false;
+    }
+    return true;
+}
+
+void FileStorage::rebuildSlots() {
+    m_slots.clear();
+    m_order.clear();
+    m_index.clear();
+    m_lastNames.clear();
+    m_slots.reserve(m_contacts.size());
+    for (size_t i = 0; i < m_contacts.size(); ++i) {
+        m_slots[m_contacts[i].getId()] = i;
+        m_order.emplace(m_contacts[i].getLastName(), m_contacts[i].getId());
+        m_index.insert(m_contacts[i].getId(), SearchIndex::searchKey(m_contacts[i]));
+        m_lastNames.insert(m_contacts[i].getId(), m_contacts[i].getLastName());
+    }
+}
+
+void FileStorage::putContact(Contact&& contact) {
+    int id = contact.getId();
+    if (id >= m_nextId) {
+        m_nextId = id + 1;
+    }
+
+    m_order.emplace(contact.getLastName(), id);
+    m_index.insert(id, SearchIndex::searchKey(contact));
+    m_lastNames.insert(id, contact.getLastName());
+
+    auto slot = m_slots.find(id);
+    if (slot != m_slots.end()) {
+        Contact& stored = m_contacts[slot->second];
+        if (stored.getLastName() != contact.getLastName()) {
+            m_order.erase({std::string(stored.getLastName()), id});
+        }
+        stored = std::move(contact);
+        return;
+    }
+    m_slots[id] = m_contacts.size();
+    m_contacts.push_back(std::move(contact));
+}
+
+bool FileStorage::removeContact(int id) {
+    auto slot = m_slots.find(id);
+    if (slot == m_slots.end()) {
+        return false;
+    }
+    
+    // Переносим последний контакт на место удаляемого, чтобы не сдвигать массив
+    size_t index = slot->second;
+    m_order.erase({std::string(m_contacts[index].getLastName()), id});
+    m_index.remove(id);
+    m_lastNames.remove(id);
+    m_slots.erase(slot);
+    if (index + 1 != m_contacts.size()) {
+        m_contacts[index] = std::move(m_contacts.back());
+        m_slots[m_contacts[index].getId()] = index;
+    }
+    m_contacts.pop_back();
+    return true;
 }
 
 bool FileStorage::addContact(const Contact& contact) {
-    std::vector<Contact> contacts;
-    if (!loadContacts(contacts)) {
+    if (!checkLoaded()) {
         return false;
     }
     
     Contact newContact = contact;
-    newContact.setId(m_nextId++);
-    contacts.push_back(newContact);
-    
-    return saveContacts(contacts);
+    newContact.setId(m_nextId);
+
+    QJsonObject record;
+    record["op"] = "add";
+    record["contact"] = contactToJson(newContact);
+    if (!appendToJournal(journalLine(record))) {
+        return false;
+    }
+
+    putContact(std::move(newContact));
+    maybeCompact();
+    return true;
 }
 
 bool FileStorage::updateContact(int id, const Contact& contact) {
-    std::vector<Contact> contacts;
-    if (!loadContacts(contacts)) {
+    if (!checkLoaded()) {
         return false;
     }
     
-    auto it = std::find_if(contacts.begin(), contacts.end(),
-        [id](const Contact& c) { return c.getId() == id; });
-    
-    if (it == contacts.end()) {
+    if (m_slots.find(id) == m_slots.end()) {
         m_lastError = "Контакт не найден";
         return false;
     }
     
-    *it = contact;
-    it->setId(id);
-    
-    return saveContacts(contacts);
+    Contact updated = contact;
+    updated.setId(id);
+
+    QJsonObject record;
+    record["op"] = "update";
+    record["contact"] = contactToJson(updated);
+    if (!appendToJournal(journalLine(record))) {
+        return false;
+    }
+
+    putContact(std::move(updated));
+    maybeCompact();
+    return true;
 }
 
 bool FileStorage::deleteContact(int id) {
-    std::vector<Contact> contacts;
-    if (!loadContacts(contacts)) {
+    if (!checkLoaded()) {
         return false;
     }
     
-    auto it = std::find_if(contacts.begin(), contacts.end(),
-        [id](const Contact& c) { return c.getId() == id; });
-    
-    if (it == contacts.end()) {
+    if (m_slots.find(id) == m_slots.end()) {
         m_lastError = "Контакт не найден";
         return false;
     }
+
+    QJsonObject record;
+    record["op"] = "delete";
+    record["id"] = id;
+    if (!appendToJournal(journalLine(record))) {
+        return false;
+    }
     
-    contacts.erase(it);
-    return saveContacts(contacts);
+    removeContact(id);
+    maybeCompact();
+    return true;
+}
+
+std::vector<bool> FileStorage::addContacts(std::vector<Contact>& contacts) {
+    std::vector<bool> results(contacts.size(), false);
+    if (!checkLoaded() || contacts.empty()) {
+        return results;
+    }
+
+    // Весь пакет уходит в журнал одной записью
+    QByteArray lines;
+    int nextId = m_nextId;
+    for (auto& contact : contacts) {
+        contact.setId(nextId++);
+        QJsonObject record;
+        record["op"] = "add";
+        record["contact"] = contactToJson(contact);
+        lines.append(journalLine(record));
+    }
+    if (!appendToJournal(lines)) {
+        for (auto& contact : contacts) {
+            contact.setId(-1);
+        }
+        return results;
+    }
+
+    m_contacts.reserve(m_contacts.size() + contacts.size());
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        putContact(Contact(contacts[i]));
+        results[i] = true;
+    }
+    maybeCompact();
+    return results;
+}
+
+std::vector<bool> FileStorage::updateContacts(const std::vector<Contact>& contacts) {
+    std::vector<bool> results(contacts.size(), false);
+    if (!checkLoaded()) {
+        return results;
+    }
+
+    QByteArray lines;
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        if (m_slots.find(contacts[i].getId()) == m_slots.end()) {
+            m_lastError = "Контакт не найден";
+            continue;
+        }
+        QJsonObject record;
+        record["op"] = "update";
+        record["contact"] = contactToJson(contacts[i]);
+        lines.append(journalLine(record));
+        results[i] = true;
+    }
+    if (lines.isEmpty()) {
+        return results;
+    }
+    if (!appendToJournal(lines)) {
+        return std::vector<bool>(contacts.size(), false);
+    }
+
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        if (results[i]) {
+            putContact(Contact(contacts[i]));
+        }
+    }
+    maybeCompact();
+    return results;
+}
+
+std::vector<bool> FileStorage::deleteContacts(const std::vector<int>& ids) {
+    std::vector<bool> results(ids.size(), false);
+    if (!checkLoaded()) {
+        return results;
+    }
+
+    QByteArray lines;
+    std::unordered_set<int> removed; // повтор id в одном пакете - ошибка
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (m_slots.find(ids[i]) == m_slots.end() || !removed.insert(ids[i]).second) {
+            m_lastError = "Контакт не найден";
+            continue;
+        }
+        QJsonObject record;
+        record["op"] = "delete";
+        record["id"] = ids[i];
+        lines.append(journalLine(record));
+        results[i] = true;
+    }
+    if (lines.isEmpty()) {
+        return results;
+    }
+    if (!appendToJournal(lines)) {
+        return std::vector<bool>(ids.size(), false);
+    }
+
+    for (int id : removed) {
+        removeContact(id);
+    }
+    maybeCompact();
+    return results;
+}
+
+bool FileStorage::getContact(int id, Contact& contact) const {
+    auto slot = m_slots.find(id);
+    if (slot == m_slots.end()) {
+        return false;
+    }
+    contact = m_contacts[slot->second];
+    return true;
 }
 
 std::vector<Contact> FileStorage::getAllContacts() const {
-    std::vector<Contact> contacts;
-    loadContacts(contacts);
-    return contacts;
+    // Копии уходят в ресурс по умолчанию и не зависят от пула
+    return std::vector<Contact>(m_contacts.begin(), m_contacts.end());
 }
 
 std::vector<Contact> FileStorage::findContacts(const QString& query) const {
-    std::vector<Contact> allContacts;
-    loadContacts(allContacts);
-    
     if (query.isEmpty()) {
-        return allContacts;
+        return getAllContacts();
     }
     
     std::vector<Contact> result;
-    QString loweredQuery = query.toLower();
-    
-    for (const auto& contact : allContacts) {
-        if (QString::fromStdString(contact.getLastName()).toLower().contains(loweredQuery) ||
-            QString::fromStdString(contact.getFirstName()).toLower().contains(loweredQuery) ||
-            QString::fromStdString(contact.getMiddleName()).toLower().contains(loweredQuery) ||
-            QString::fromStdString(contact.getEmail()).toLower().contains(loweredQuery)) {
-            result.push_back(contact);
+    forEachMatch(query, [&result](const Contact& contact) {
+        result.push_back(contact);
+        return true;
+    });
+    return result;
+}
+
+bool FileStorage::forEachContact(const ContactVisitor& visitor) const {
+    for (const auto& contact : m_contacts) {
+        if (!visitor(contact)) {
+            return false;
         }
     }
-    
+    return true;
+}
+
+bool FileStorage::forEachMatch(const QString& query, const ContactVisitor& visitor) const {
+    if (query.isEmpty()) {
+        return forEachContact(visitor);
+    }
+
+    // Кандидаты берутся из триграммного индекса, а не перебором всей книги
+    for (int id : m_index.find(SearchIndex::fold(query))) {
+        if (!visitor(m_contacts[m_slots.at(id)])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> FileStorage::completeLastName(const QString& prefix, int limit) const {
+    return m_lastNames.complete(SearchIndex::fold(prefix), limit);
+}
+
+std::vector<Contact> FileStorage::findByLastNamePrefix(const QString& prefix, int limit) const {
+    std::vector<Contact> result;
+    for (int id : m_lastNames.range(SearchIndex::fold(prefix), limit)) {
+        result.push_back(m_contacts[m_slots.at(id)]);
+    }
     return result;
 }
 
+bool FileStorage::matchesQuery(const Contact& contact, const QString& query) const {
+    return query.isEmpty() ||
+           SearchIndex::searchKey(contact).find(SearchIndex::fold(query)) != std::string::npos;
+}
+
+std::vector<Contact> FileStorage::getContactsPage(const ContactPageKey& after, int limit) const {
+    std::vector<Contact> page;
+    if (limit <= 0) {
+        return page;
+    }
+    page.reserve(size_t(limit));
+
+    for (auto it = m_order.upper_bound({after.lastName, after.id});
+         it != m_order.end() && int(page.size()) < limit; ++it) {
+        page.push_back(m_contacts[m_slots.at(it->second)]);
+    }
+    return page;
+}
+
 QString FileStorage::getLastError() const {
     return m_lastError;
 }
 
-bool FileStorage::saveContacts(const std::vector<Contact>& contacts) {
+QByteArray FileStorage::journalLine(const QJsonObject& record) {
+    // Одна операция - одна строка компактного JSON
+    QByteArray line = QJsonDocument(record).toJson(QJsonDocument::Compact);
+    line.append('\n');
+    return line;
+}
+
+bool FileStorage::appendToJournal(const QByteArray& lines) {
+    if (!m_journal.isOpen()) {
+        m_journal.setFileName(m_journalPath);
+        if (!m_journal.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            m_lastError = "Не удалось открыть журнал для записи";
+            return false;
+        }
+    }
+
+    if (m_journal.write(lines) != lines.size() || !m_journal.flush()) {
+        // Отрезаем недописанные строки; журнал откроется заново при следующей записи
+        m_journal.close();
+        if (!QFile::resize(m_journalPath, m_journalSize)) {
+            m_journalBroken = true;
+        }
+        m_lastError = "Не удалось записать журнал";
+        return false;
+    }
+    m_journalSize += lines.size();
+    return true;
+}
+
+bool FileStorage::replayJournal(const QString& journalPath) {
+    QFile file(journalPath);
+    if (!file.exists()) {
+        return true;
+    }
+
+    if (!file.open(QIODevice::ReadWrite)) {
+        m_lastError = "Не удалось открыть журнал для чтения";
+        return false;
+    }
+
+    qint64 validSize = 0;
+    while (!file.atEnd()) {
+        QByteArray line = file.readLine();
+        if (line.trimmed().isEmpty()) {
+            validSize = file.pos();
+            continue;
+        }
+
+        QJsonParseError error;
+        QJsonDocument document = QJsonDocument::fromJson(line, &error);
+        if (error.error != QJsonParseError::NoError || !document.isObject() ||
+            !line.endsWith('\n')) {
+            // Недописанная запись после сбоя: отрезаем хвост, чтобы
+            // новые записи не оказались за ним
+            qDebug() << "Journal truncated at offset" << validSize << "in" << journalPath;
+            file.resize(validSize);
+            break;
+        }
+
+        QJsonObject record = document.object();
+        QString op = record["op"].toString();
+        if (op == "delete") {
+            removeContact(record["id"].toInt());
+        } else if (op == "add" || op == "update") {
+            // Запись содержит контакт целиком, поэтому повторный накат безопасен
+            putContact(jsonToContact(record["contact"].toObject()));
+        }
+        validSize = file.pos();
+    }
+
+    return true;
+}
+
+void FileStorage::maybeCompact() {
+    finishCompaction(false);
+    if (m_compacting) {
+        return;
+    }
+
+    qint64 threshold = qMax(kMinCompactionThreshold, m_snapshotSize / 2);
+    if (m_journalSize > threshold) {
+        startCompaction();
+    }
+}
+
+void FileStorage::startCompaction() {
+    m_journal.close();
+
+    // Текущий журнал становится "старым": новые операции пойдут в свежий файл,
+    // а старый удалится только после записи снимка
+    if (QFile::exists(m_journalPath)) {
+        if (QFile::exists(m_oldJournalPath)) {
+            // Предыдущее уплотнение не удалось - дописываем журнал к старому
+            QFile current(m_journalPath);
+            QFile old(m_oldJournalPath);
+            if (!current.open(QIODevice::ReadOnly) ||
+                !old.open(QIODevice::WriteOnly | QIODevice::Append) ||
+                old.write(current.readAll()) < 0) {
+                m_lastError = "Не удалось перенести журнал";
+                return;
+            }
+            old.close();
+            current.close();
+            QFile::remove(m_journalPath);
+        } else if (!QFile::rename(m_journalPath, m_oldJournalPath)) {
+            m_lastError = "Не удалось перенести журнал";
+            return;
+        }
+    } else if (!QFile::exists(m_oldJournalPath)) {
+        return; // Сворачивать нечего
+    }
+    m_journalSize = 0;
+
+    // Пишем снимок в фоне по копии контактов. Копия pmr-вектора размещается
+    // в ресурсе по умолчанию: пул не потокобезопасен, фон его не трогает
+    m_compacting = true;
+    m_compaction = QtConcurrent::run(&FileStorage::saveContacts, m_filePath, m_contacts);
+}
+
+void FileStorage::finishCompaction(bool wait) {
+    if (!m_compacting) {
+        return;
+    }
+    if (!wait && !m_compaction.isFinished()) {
+        return;
+    }
+
+    qint64 size = m_compaction.result();
+    m_compacting = false;
+    if (size < 0) {
+        // Старый журнал остается и будет накатан при следующем открытии
+        m_lastError = "Не удалось записать снимок контактов";
+        qDebug() << "Compaction failed:" << m_filePath;
+        return;
+    }
+
+    m_snapshotSize = size;
+    QFile::remove(m_oldJournalPath);
+}
+
+bool FileStorage::compact() {
+    if (!checkLoaded()) {
+        return false;
+    }
+
+    finishCompaction(true);
+    startCompaction();
+    finishCompaction(true);
+    return !QFile::exists(m_oldJournalPath);
+}
+
+qint64 FileStorage::saveContacts(const QString& filePath, const std::pmr::vector<Contact>& contacts) {
     QJsonArray jsonArray;
     
     for (const auto& contact : contacts) {
         jsonArray.append(contactToJson(contact));
     }
     
-    QJsonDocument document(jsonArray);
-    QFile file(m_filePath);
-    
+    QByteArray data = QJsonDocument(jsonArray).toJson();
+
+    // QSaveFile подменяет файл только после успешной записи
+    QSaveFile file(filePath);
     if (!file.open(QIODevice::WriteOnly)) {
-        m_lastError = "Не удалось открыть файл для записи";
-        return false;
+        return -1;
     }
     
-    file.write(document.toJson());
-    return true;
+    if (file.write(data) != data.size() || !file.commit()) {
+        return -1;
+    }
+    return data.size();
 }
 
-bool FileStorage::loadContacts(std::vector<Contact>& contacts) const {
+bool FileStorage::loadContacts(std::pmr::vector<Contact>& contacts) const {
     QFile file(m_filePath);
     
     if (!file.exists()) {
@@ -144,27 +569,28 @@ bool FileStorage::loadContacts(std::vector<Contact>& contacts) const {
     
     for (const auto& value : jsonArray) {
         if (!value.isObject()) continue;
-        contacts.push_back(jsonToContact(value.toObject()));
+        // Контакт сразу собирается в ресурсе списка, без перекладывания строк
+        contacts.push_back(jsonToContact(value.toObject(), contacts.get_allocator()));
     }
     
     return true;
 }
 
-QJsonObject FileStorage::contactToJson(const Contact& contact) const {
+QJsonObject FileStorage::contactToJson(const Contact& contact) {
     QJsonObject json;
     json["id"] = contact.getId();
-    json["lastName"] = QString::fromStdString(contact.getLastName());
-    json["firstName"] = QString::fromStdString(contact.getFirstName());
-    json["middleName"] = QString::fromStdString(contact.getMiddleName());
-    json["birthDate"] = QString::fromStdString(contact.getBirthDate());
-    json["address"] = QString::fromStdString(contact.getAddress());
-    json["email"] = QString::fromStdString(contact.getEmail());
+    json["lastName"] = toQString(contact.getLastName());
+    json["firstName"] = toQString(contact.getFirstName());
+    json["middleName"] = toQString(contact.getMiddleName());
+    json["birthDate"] = toQString(contact.getBirthDate());
+    json["address"] = toQString(contact.getAddress());
+    json["email"] = toQString(contact.getEmail());
     
     QJsonArray phonesArray;
     for (const auto& phone : contact.getPhoneNumbers()) {
         QJsonObject phoneJson;
-        phoneJson["number"] = QString::fromStdString(phone.getNumber());
-        phoneJson["type"] = QString::fromStdString(phone.getType());
+        phoneJson["number"] = toQString(phone.getNumber());
+        phoneJson["type"] = toQString(phone.getType());
         phonesArray.append(phoneJson);
     }
     json["phones"] = phonesArray;
@@ -172,24 +598,22 @@ QJsonObject FileStorage::contactToJson(const Contact& contact) const {
     return json;
 }
 
-Contact FileStorage::jsonToContact(const QJsonObject& json) const {
-    Contact contact;
-    contact.setId(json["id"].toInt());
-    contact.setLastName(json["lastName"].toString().toStdString());
-    contact.setFirstName(json["firstName"].toString().toStdString());
-    contact.setMiddleName(json["middleName"].toString().toStdString());
-    contact.setBirthDate(json["birthDate"].toString().toStdString());
-    contact.setAddress(json["address"].toString().toStdString());
-    contact.setEmail(json["email"].toString().toStdString());
+Contact FileStorage::jsonToContact(const QJsonObject& json, const Contact::allocator_type& alloc) {
+    // Снимок и журнал пишет само хранилище - проверки не повторяем
+    Contact contact = Contact::fromStorage(json["id"].toInt(),
+                                           Utf8(json["lastName"].toString()),
+                                           Utf8(json["firstName"].toString()),
+                                           Utf8(json["middleName"].toString()),
+                                           Utf8(json["birthDate"].toString()),
+                                           Utf8(json["address"].toString()),
+                                           Utf8(json["email"].toString()),
+                                           alloc);
     
     QJsonArray phonesArray = json["phones"].toArray();
     for (const auto& value : phonesArray) {
         QJsonObject phoneJson = value.toObject();
-        PhoneNumber phone(
-            phoneJson["number"].toString().toStdString(),
-            phoneJson["type"].toString().toStdString()
-        );
-        contact.addPhoneNumber(phone);
+        contact.addStoredPhoneNumber(Utf8(phoneJson["number"].toString()),
+                                     Utf8(phoneJson["type"].toString()));
     }
     
     return contact;
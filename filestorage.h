@@ -1,28 +1,87 @@
 #pragma once
 #include "istorage.h"
+#include "searchindex.h"
+#include "prefixindex.h"
 #include <QFile>
+#include <QFuture>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QJsonObject>
+#include <memory_resource>
+#include <set>
+#include <unordered_map>
+#include <unordered_set>
 
+// Хранилище в JSON-файле.
+// phonebook.json - снимок всей книги, рядом лежит журнал phonebook.json.journal,
+// куда каждая операция дописывается одной строкой. При открытии журнал
+// накатывается на снимок, а когда он вырастает, фоновое уплотнение
+// сворачивает его в новый снимок.
 class FileStorage : public IStorage {
 public:
     explicit FileStorage(const QString& filePath);
-    
+    ~FileStorage() override;
+
     bool addContact(const Contact& contact) override;
     bool updateContact(int id, const Contact& contact) override;
     bool deleteContact(int id) override;
+    std::vector<bool> addContacts(std::vector<Contact>& contacts) override;
+    std::vector<bool> updateContacts(const std::vector<Contact>& contacts) override;
+    std::vector<bool> deleteContacts(const std::vector<int>& ids) override;
+    bool getContact(int id, Contact& contact) const override;
     std::vector<Contact> getAllContacts() const override;
     std::vector<Contact> findContacts(const QString& query) const override;
+    std::vector<Contact> getContactsPage(const ContactPageKey& after, int limit) const override;
+    bool forEachContact(const ContactVisitor& visitor) const override;
+    bool forEachMatch(const QString& query, const ContactVisitor& visitor) const override;
+    std::vector<std::string> completeLastName(const QString& prefix, int limit) const override;
+    std::vector<Contact> findByLastNamePrefix(const QString& prefix, int limit) const override;
+    bool matchesQuery(const Contact& contact, const QString& query) const override;
     QString getLastError() const override;
 
+    // Синхронно сворачивает журнал в снимок
+    bool compact();
+    // Приблизительный объем триграммного индекса в байтах
+    size_t searchIndexMemoryUsage() const { return m_index.memoryUsage(); }
+
 private:
     QString m_filePath;
+    QString m_journalPath;
+    QString m_oldJournalPath;   // журнал, который сейчас сворачивается в снимок
     QString m_lastError;
     int m_nextId;
-    
-    bool saveContacts(const std::vector<Contact>& contacts);
-    bool loadContacts(std::vector<Contact>& contacts) const;
-    QJsonObject contactToJson(const Contact& contact) const;
-    Contact jsonToContact(const QJsonObject& json) const;
-}; 
\ No newline at end of file
+    bool m_loaded;
+    bool m_journalBroken;       // недописанный хвост журнала не удалось отрезать
+    qint64 m_snapshotSize;
+    qint64 m_journalSize;
+    QFile m_journal;
+    QFuture<qint64> m_compaction;
+    bool m_compacting;
+
+    // Резидентная копия телефонной книги: файл читается один раз,
+    // дальше все операции работают с памятью. Строки контактов лежат в пуле,
+    // который берет память крупными блоками и переиспользует освобожденное
+    // при правках; весь пул отдается разом при закрытии хранилища
+    std::pmr::unsynchronized_pool_resource m_pool;
+    std::pmr::vector<Contact> m_contacts{&m_pool};
+    std::unordered_map<int, size_t> m_slots; // id -> индекс в m_contacts
+    std::set<std::pair<std::string, int>> m_order; // (фамилия, id) для постраничной выборки
+    SearchIndex m_index;                           // триграммы для поиска подстроки
+    PrefixIndex m_lastNames;                       // фамилии для автодополнения
+
+    static qint64 saveContacts(const QString& filePath, const std::pmr::vector<Contact>& contacts);
+    bool loadContacts(std::pmr::vector<Contact>& contacts) const;
+    bool replayJournal(const QString& journalPath);
+    bool appendToJournal(const QByteArray& lines);
+    static QByteArray journalLine(const QJsonObject& record);
+    void maybeCompact();
+    void startCompaction();
+    void finishCompaction(bool wait);
+    bool checkLoaded();
+    void rebuildSlots();
+    void putContact(Contact&& contact);
+    bool removeContact(int id);
+    static QJsonObject contactToJson(const Contact& contact);
+    static Contact jsonToContact(const QJsonObject& json,
+                                 const Contact::allocator_type& alloc = Contact::allocator_type());
+};
\ No newline at end of file
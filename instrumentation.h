@@ -0,0 +1,34 @@
+#pragma once
+#include <atomic>
+
+// Счетчики жизненного цикла объектов (конструирование, копирование, перемещение...).
+// Включаются определением PHONEBOOK_LIFETIME_STATS (см. Neior4ik.pro).
+// Включенный счетчик - атомарный с relaxed-порядком: нужна только сумма,
+// а не упорядочивание с другими операциями. Выключенный - пустой тип,
+// вызовы которого компилятор убирает полностью.
+#ifdef PHONEBOOK_LIFETIME_STATS
+
+constexpr bool kLifetimeStatsEnabled = true;
+
+class LifetimeCounter {
+public:
+    void increment() { m_value.fetch_add(1, std::memory_order_relaxed); }
+    int value() const { return m_value.load(std::memory_order_relaxed); }
+    void reset() { m_value.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<int> m_value{0};
+};
+
+#else
+
+constexpr bool kLifetimeStatsEnabled = false;
+
+class LifetimeCounter {
+public:
+    void increment() {}
+    int value() const { return 0; }
+    void reset() {}
+};
+
+#endif
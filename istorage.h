@@ -1,8 +1,24 @@
 #pragma once
+#include <functional>
 #include <vector>
 #include "contact.h"
 #include <QString>
 
+// Позиция в списке контактов, упорядоченном по (фамилия, id).
+// Ключ по умолчанию указывает на начало списка.
+struct ContactPageKey {
+    std::string lastName;
+    int id = 0;
+
+    static ContactPageKey after(const Contact& contact) {
+        return {std::string(contact.getLastName()), contact.getId()};
+    }
+};
+
+// Обработчик потокового обхода. Контакт действителен только на время вызова;
+// вернув false, обработчик прекращает обход.
+using ContactVisitor = std::function<bool(const Contact&)>;
+
 class IStorage {
 public:
     virtual ~IStorage() = default;
@@ -10,7 +26,43 @@ public:
     virtual bool addContact(const Contact& contact) = 0;
     virtual bool updateContact(int id, const Contact& contact) = 0;
     virtual bool deleteContact(int id) = 0;
+
+    // Пакетные операции: весь пакет применяется за одну транзакцию (одну запись).
+    // Результат - признак успеха для каждого элемента в том же порядке.
+    // addContacts записывает присвоенные id обратно в добавленные контакты,
+    // updateContacts обновляет контакты по их собственным id.
+    virtual std::vector<bool> addContacts(std::vector<Contact>& contacts) = 0;
+    virtual std::vector<bool> updateContacts(const std::vector<Contact>& contacts) = 0;
+    virtual std::vector<bool> deleteContacts(const std::vector<int>& ids) = 0;
+
+    // Контакт по id; false, если такого контакта нет
+    virtual bool getContact(int id, Contact& contact) const = 0;
     virtual std::vector<Contact> getAllContacts() const = 0;
     virtual std::vector<Contact> findContacts(const QString& query) const = 0;
+
+    // Страница из не более чем limit контактов, следующих за ключом after
+    // в порядке (фамилия, id). Следующая страница запрашивается по ключу
+    // последнего полученного контакта (ContactPageKey::after).
+    virtual std::vector<Contact> getContactsPage(const ContactPageKey& after, int limit) const = 0;
+
+    // Потоковый обход без сборки вектора контактов.
+    // Возвращают true, если обход дошел до конца.
+    virtual bool forEachContact(const ContactVisitor& visitor) const = 0;
+    virtual bool forEachMatch(const QString& query, const ContactVisitor& visitor) const = 0;
+
+    // Автодополнение фамилии: до limit различных фамилий, начинающихся с prefix
+    // (без учета регистра, ё = е), в алфавитном порядке
+    virtual std::vector<std::string> completeLastName(const QString& prefix, int limit) const = 0;
+    // До limit контактов с фамилией на prefix, по фамилии
+    virtual std::vector<Contact> findByLastNamePrefix(const QString& prefix, int limit) const = 0;
+
+    // Проверяет один контакт по тем же правилам, что и findContacts/forEachMatch
+    virtual bool matchesQuery(const Contact& contact, const QString& query) const = 0;
+    // true, если результат query - подмножество результата previous, то есть его
+    // можно получить, отфильтровав результат previous через matchesQuery.
+    // Для поиска подстроки это верно для любого удлинения запроса.
+    virtual bool narrows(const QString& previous, const QString& query) const {
+        return query.startsWith(previous);
+    }
     virtual QString getLastError() const = 0;
 }; 
\ No newline at end of file
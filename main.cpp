@@ -3,6 +3,7 @@
 #include "mainwindow.h"
 #include "databasestorage.h"
 #include "filestorage.h"
+#include "binarystorage.h"
 #include "storagechoicedialog.h"
 #include <QDir>
 
@@ -18,12 +19,16 @@ int main(int argc, char *argv[])
     
     try {
         std::unique_ptr<IStorage> storage;
-        if (dialog.useDatabase()) {
-            QString dbPath = QDir::currentPath() + "/phonebook.db";
-            storage = std::make_unique<DatabaseStorage>(dbPath);
-        } else {
-            QString filePath = QDir::currentPath() + "/phonebook.json";
-            storage = std::make_unique<FileStorage>(filePath);
+        switch (dialog.storageType()) {
+        case StorageChoiceDialog::Database:
+            storage = std::make_unique<DatabaseStorage>(QDir::currentPath() + "/phonebook.db");
+            break;
+        case StorageChoiceDialog::JsonFile:
+            storage = std::make_unique<FileStorage>(QDir::currentPath() + "/phonebook.json");
+            break;
+        case StorageChoiceDialog::BinaryFile:
+            storage = std::make_unique<BinaryStorage>(QDir::currentPath() + "/phonebook.pbk");
+            break;
         }
         
         MainWindow w(std::move(storage));
@@ -11,8 +11,16 @@
 #include <QHBoxLayout>
 #include <QPushButton>
 #include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QFileDialog>
+#include <QProgressDialog>
 #include <algorithm>
 
+namespace {
+constexpr int kMinPrefixLength = 2;
+constexpr int kMaxSuggestions = 10;
+}
+
 MainWindow::MainWindow(std::unique_ptr<IStorage> storage, QWidget *parent)
     : QMainWindow(parent)
 {
@@ -21,11 +29,32 @@ MainWindow::MainWindow(std::unique_ptr<IStorage> storage, QWidget *parent)
     // Инициализируем телефонную книгу
     phoneBook = std::make_unique<PhoneBook>(std::move(storage));
     
-    // Обновляем таблицу
-    updateTable();
+    // Модель сама читает книгу страницами и следит за ее изменениями
+    contactsModel = new ContactTableModel(phoneBook.get(), this);
+    contactsTable->setModel(contactsModel);
+    
+    // Импорт из CSV и vCard; первые ошибки записей показываются в итоге импорта
+    importer = std::make_unique<ContactImporter>(phoneBook.get());
+    connect(importer.get(), &ContactImporter::recordFailed, this,
+            [this](qint64 record, const QString& reason) {
+        const int kMaxShownErrors = 10;
+        if (importErrors.size() < kMaxShownErrors) {
+            importErrors.append(QString("Запись %1: %2").arg(record).arg(reason));
+        }
+    });
+    
+    // Подсказки фамилий ждут той же паузы в наборе, что и поиск
+    completionTimer = new QTimer(this);
+    completionTimer->setSingleShot(true);
+    completionTimer->setInterval(ContactTableModel::kSearchDelayMs);
+    connect(completionTimer, &QTimer::timeout, this, &MainWindow::startCompletion);
+    completionWatcher = new QFutureWatcher<QStringList>(this);
+    connect(completionWatcher, &QFutureWatcher<QStringList>::finished,
+            this, &MainWindow::onCompletionReady);
     
     // Подключаем сигналы
     connect(searchEdit, &QLineEdit::textChanged, this, &MainWindow::onSearch);
+    connect(searchEdit, &QLineEdit::textEdited, this, &MainWindow::onCompleteLastName);
 }
 
 void MainWindow::setupUI() {
@@ -38,16 +67,19 @@ void MainWindow::setupUI() {
     auto searchLayout = new QHBoxLayout;
     searchEdit = new QLineEdit(this);
     searchEdit->setPlaceholderText("Поиск...");
+    
+    // Подсказки фамилий; список уже отобран по префиксу хранилищем
+    lastNameModel = new QStringListModel(this);
+    lastNameCompleter = new QCompleter(lastNameModel, this);
+    lastNameCompleter->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+    searchEdit->setCompleter(lastNameCompleter);
     searchLayout->addWidget(searchEdit);
     mainLayout->addLayout(searchLayout);
     
     // Table
-    contactsTable = new QTableWidget(this);
-    contactsTable->setColumnCount(7);
-    contactsTable->setHorizontalHeaderLabels({
-        "Фамилия", "Имя", "Отчество", "Дата рождения", 
-        "Адрес", "Email", "Телефоны"
-    });
+    contactsTable = new QTableView(this);
+    contactsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    contactsTable->setSelectionMode(QAbstractItemView::SingleSelection);
     contactsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     mainLayout->addWidget(contactsTable);
     
@@ -56,21 +88,26 @@ void MainWindow::setupUI() {
     auto addButton = new QPushButton("Добавить", this);
     auto editButton = new QPushButton("Изменить", this);
     auto deleteButton = new QPushButton("Удалить", this);
-    // auto statsButton = new QPushButton("Статистика", this);
+    auto importButton = new QPushButton("Импорт", this);
     
     buttonLayout->addWidget(addButton);
     buttonLayout->addWidget(editButton);
     buttonLayout->addWidget(deleteButton);
-    // buttonLayout->addWidget(statsButton);
+    buttonLayout->addWidget(importButton);
+#ifdef PHONEBOOK_LIFETIME_STATS
+    auto statsButton = new QPushButton("Статистика", this);
+    buttonLayout->addWidget(statsButton);
+    connect(statsButton, &QPushButton::clicked, this, [this]() {
+        QMessageBox::information(this, "Статистика", Contact::getStats());
+    });
+#endif
     mainLayout->addLayout(buttonLayout);
     
     // Connections
     connect(addButton, &QPushButton::clicked, this, &MainWindow::onAdd);
     connect(editButton, &QPushButton::clicked, this, &MainWindow::onEdit);
     connect(deleteButton, &QPushButton::clicked, this, &MainWindow::onDelete);
-    // connect(statsButton, &QPushButton::clicked, this, [this]() {
-    //     QMessageBox::information(this, "Статистика", Contact::getStats());
-    // });
+    connect(importButton, &QPushButton::clicked, this, &MainWindow::onImport);
     
     setWindowTitle("Телефонная книга");
     resize(1400, 600);
@@ -81,42 +118,13 @@ void MainWindow::setupUI() {
     int y = (screenGeometry.height() - height()) / 2;
     move(x, y);
 
-    // Включаем сортировку
-    contactsTable->setSortingEnabled(true);
-    
-    // Устанавливаем сортировку по умолчанию по фамилии
-    contactsTable->sortByColumn(0, Qt::AscendingOrder);
+    // Контакты всегда идут по фамилии: в этом порядке их отдает постраничное
+    // чтение хранилища, поэтому сортировка по столбцам не включается
 }
 
-void MainWindow::updateTable() {
-    contactsTable->setSortingEnabled(false);  // Отключаем сортировку на время обновления
-    contactsTable->setRowCount(0);
-    
-    auto contacts = phoneBook->getContacts();
-    for (const auto& contact : contacts) {
-        int row = contactsTable->rowCount();
-        contactsTable->insertRow(row);
-        
-        auto* lastNameItem = new QTableWidgetItem(QString::fromStdString(contact.getLastName()));
-        lastNameItem->setData(Qt::UserRole, contact.getId());
-        contactsTable->setItem(row, 0, lastNameItem);
-        
-        contactsTable->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(contact.getFirstName())));
-        contactsTable->setItem(row, 2, new QTableWidgetItem(QString::fromStdString(contact.getMiddleName())));
-        contactsTable->setItem(row, 3, new QTableWidgetItem(QString::fromStdString(contact.getBirthDate())));
-        contactsTable->setItem(row, 4, new QTableWidgetItem(QString::fromStdString(contact.getAddress())));
-        contactsTable->setItem(row, 5, new QTableWidgetItem(QString::fromStdString(contact.getEmail())));
-        
-        QString phones;
-        for (const auto& phone : contact.getPhoneNumbers()) {
-            if (!phones.isEmpty()) phones += "\n";
-            phones += QString::fromStdString(phone.getType()) + ": " +
-                     QString::fromStdString(phone.getNumber());
-        }
-        contactsTable->setItem(row, 6, new QTableWidgetItem(phones));
-    }
-    
-    contactsTable->setSortingEnabled(true);  // Включаем сортировку обратно
+int MainWindow::selectedContactId() const {
+    QModelIndex current = contactsTable->currentIndex();
+    return current.isValid() ? contactsModel->contactId(current.row()) : -1;
 }
 
 void MainWindow::onAdd() {
@@ -124,10 +132,8 @@ void MainWindow::onAdd() {
         ContactDialog dialog(this);
         if (dialog.exec() == QDialog::Accepted) {
             Contact newContact = dialog.getContact();
-            if (phoneBook->addContact(std::move(newContact))) {
-                // Обновляем таблицу с учетом поиска
-                onSearch();  // Вместо updateTable()
-            } else {
+            // Строка появится в таблице по сигналу contactAdded
+            if (!phoneBook->addContact(std::move(newContact))) {
                 QMessageBox::critical(this, "Ошибка",
                     "Не удалось добавить контакт: " + phoneBook->getLastError());
             }
@@ -139,30 +145,21 @@ void MainWindow::onAdd() {
 }
 
 void MainWindow::onEdit() {
-    int row = contactsTable->currentRow();
-    if (row < 0) {
+    int contactId = selectedContactId();
+    if (contactId < 0) {
         QMessageBox::warning(this, "Предупреждение", "Выберите контакт для редактирования");
         return;
     }
     
-    // Получаем ID контакта из таблицы
-    int contactId = contactsTable->item(row, 0)->data(Qt::UserRole).toInt();
-    
-    // Находим контакт по ID
-    auto contacts = phoneBook->getContacts();
-    auto it = std::find_if(contacts.begin(), contacts.end(),
-        [contactId](const Contact& c) { return c.getId() == contactId; });
-    
-    if (it == contacts.end()) return;
+    Contact contact;
+    if (!phoneBook->getContact(contactId, contact)) return;
     
     try {
-        ContactDialog dialog(*it, this);
+        ContactDialog dialog(contact, this);
         if (dialog.exec() == QDialog::Accepted) {
             Contact updatedContact = dialog.getContact();
             updatedContact.setId(contactId);
-            if (phoneBook->updateContact(contactId, std::move(updatedContact))) {
-                onSearch();
-            } else {
+            if (!phoneBook->updateContact(contactId, updatedContact)) {
                 QMessageBox::critical(this, "Ошибка",
                     "Не удалось обновить контакт: " + phoneBook->getLastError());
             }
@@ -174,78 +171,112 @@ void MainWindow::onEdit() {
 }
 
 void MainWindow::onDelete() {
-    int row = contactsTable->currentRow();
-    if (row < 0) {
+    int contactId = selectedContactId();
+    if (contactId < 0) {
         QMessageBox::warning(this, "Предупреждение",
             "Выберите контакт для удаления");
         return;
     }
     
-    auto contacts = phoneBook->getContacts();
-    if (row >= static_cast<int>(contacts.size())) {
-        return;
-    }
-    
     if (QMessageBox::question(this, "Подтверждение",
         "Вы действительно хотите удалить этот контакт?",
         QMessageBox::Yes | QMessageBox::No) == QMessageBox::Yes) {
         
-        if (phoneBook->deleteContact(contacts[row].getId())) {
-            // Обновляем таблицу с учетом поиска
-            onSearch();  // Вместо updateTable()
-        } else {
+        if (!phoneBook->deleteContact(contactId)) {
             QMessageBox::critical(this, "Ошибка",
                 "Не удалось удалить контакт: " + phoneBook->getLastError());
         }
     }
 }
 
-void MainWindow::onSearch() {
-    QString query = searchEdit->text().toLower();
-    auto contacts = phoneBook->getContacts();
-    
-    contactsTable->setSortingEnabled(false);  // Отключаем сортировку на время обновления
-    contactsTable->setRowCount(0);
-    
-    for (const auto& contact : contacts) {
-        bool matches = query.isEmpty() ||
-            QString::fromStdString(contact.getLastName()).toLower().contains(query) ||
-            QString::fromStdString(contact.getFirstName()).toLower().contains(query) ||
-            QString::fromStdString(contact.getMiddleName()).toLower().contains(query) ||
-            QString::fromStdString(contact.getBirthDate()).toLower().contains(query) ||
-            QString::fromStdString(contact.getAddress()).toLower().contains(query) ||
-            QString::fromStdString(contact.getEmail()).toLower().contains(query);
-        
-        for (const auto& phone : contact.getPhoneNumbers()) {
-            if (QString::fromStdString(phone.getNumber()).toLower().contains(query)) {
-                matches = true;
-                break;
-            }
+void MainWindow::onImport() {
+    QString fileName = QFileDialog::getOpenFileName(this, "Импорт контактов", QString(),
+        "Контакты (*.csv *.vcf *.vcard);;CSV (*.csv);;vCard (*.vcf *.vcard);;Все файлы (*)");
+    if (fileName.isEmpty()) {
+        return;
+    }
+    
+    importErrors.clear();
+    if (!importer->start(fileName)) {
+        QMessageBox::critical(this, "Ошибка",
+            "Не удалось начать импорт: " + importer->getLastError());
+        return;
+    }
+    
+    // Контакты появляются в таблице по мере добавления пакетов (contactsChanged).
+    // Связи с диалогом рвутся при его удалении в конце импорта
+    const int kProgressSteps = 1000;
+    auto* progress = new QProgressDialog("Импорт контактов...", "Отмена", 0, kProgressSteps, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(0);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    progress->setValue(0);
+    connect(progress, &QProgressDialog::canceled, importer.get(), &ContactImporter::cancel);
+    connect(importer.get(), &ContactImporter::progress, progress,
+            [progress, kProgressSteps](qint64 processed, qint64 total) {
+        if (total > 0) {
+            progress->setValue(static_cast<int>(processed * kProgressSteps / total));
         }
-        
-        if (matches) {
-            int row = contactsTable->rowCount();
-            contactsTable->insertRow(row);
-            
-            auto* lastNameItem = new QTableWidgetItem(QString::fromStdString(contact.getLastName()));
-            lastNameItem->setData(Qt::UserRole, contact.getId());
-            contactsTable->setItem(row, 0, lastNameItem);
-            
-            contactsTable->setItem(row, 1, new QTableWidgetItem(QString::fromStdString(contact.getFirstName())));
-            contactsTable->setItem(row, 2, new QTableWidgetItem(QString::fromStdString(contact.getMiddleName())));
-            contactsTable->setItem(row, 3, new QTableWidgetItem(QString::fromStdString(contact.getBirthDate())));
-            contactsTable->setItem(row, 4, new QTableWidgetItem(QString::fromStdString(contact.getAddress())));
-            contactsTable->setItem(row, 5, new QTableWidgetItem(QString::fromStdString(contact.getEmail())));
-            
-            QString phones;
-            for (const auto& phone : contact.getPhoneNumbers()) {
-                if (!phones.isEmpty()) phones += "\n";
-                phones += QString::fromStdString(phone.getType()) + ": " +
-                         QString::fromStdString(phone.getNumber());
+    });
+    connect(importer.get(), &ContactImporter::finished, progress,
+            [this, progress](qint64 imported, qint64 failed, const QString& error) {
+        progress->deleteLater();
+        QString message = QString("Импортировано контактов: %1\nПропущено записей: %2")
+            .arg(imported).arg(failed);
+        if (!error.isEmpty()) {
+            message += "\n\n" + error;
+        }
+        if (!importErrors.isEmpty()) {
+            message += "\n\n" + importErrors.join('\n');
+            if (failed > importErrors.size()) {
+                message += "\n...";
             }
-            contactsTable->setItem(row, 6, new QTableWidgetItem(phones));
         }
+        QMessageBox::information(this, "Импорт", message);
+    });
+}
+
+void MainWindow::onSearch() {
+    contactsModel->setFilter(searchEdit->text());
+}
+
+void MainWindow::onCompleteLastName(const QString& text) {
+    if (text.trimmed().size() < kMinPrefixLength) {
+        completionTimer->stop();
+        lastNameModel->setStringList({});
+        return;
+    }
+    completionTimer->start();
+}
+
+void MainWindow::startCompletion() {
+    // Прежний запрос еще идет: новый начнется, когда он закончится
+    if (completionWatcher->isRunning()) {
+        completionPending = true;
+        return;
+    }
+    completionText = searchEdit->text();
+    if (completionText.trimmed().size() < kMinPrefixLength) {
+        return;
+    }
+    // Подсказки собираются в фоне, чтобы набор не ждал хранилище
+    completionWatcher->setFuture(phoneBook->completeLastNameAsync(completionText.trimmed(), kMaxSuggestions));
+}
+
+void MainWindow::onCompletionReady() {
+    if (completionPending) {
+        completionPending = false;
+        startCompletion();
+        return;
+    }
+    // Пока искали, строку могли изменить - такие подсказки уже не нужны
+    if (searchEdit->text() != completionText) {
+        return;
+    }
+    QStringList names = completionWatcher->result();
+    lastNameModel->setStringList(names);
+    if (!names.isEmpty()) {
+        lastNameCompleter->complete();
     }
-    
-    contactsTable->setSortingEnabled(true);  // Включаем сортировку обратно
 }
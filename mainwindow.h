@@ -1,15 +1,22 @@
 #pragma once
 #include <QMainWindow>
-#include <QTableWidget>
+#include <QTableView>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QComboBox>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QStringList>
+#include <QTimer>
+#include <QFutureWatcher>
 #include <memory>
 #include "phonebook.h"
 #include "contactdialog.h"
+#include "contacttablemodel.h"
+#include "contactimporter.h"
 #include "istorage.h"
 
 class MainWindow : public QMainWindow {
@@ -22,16 +29,31 @@ private slots:
     void onAdd();
     void onEdit();
     void onDelete();
+    void onImport();
     void onSearch();
-    void updateTable();
+    void onCompleteLastName(const QString& text);
+    void startCompletion();
+    void onCompletionReady();
 
 private:
     std::unique_ptr<PhoneBook> phoneBook;
-    QTableWidget* contactsTable;
+    // Объявлен после phoneBook: удаляется раньше книги и дожидается импорта
+    std::unique_ptr<ContactImporter> importer;
+    QStringList importErrors;   // первые ошибки текущего импорта
+    ContactTableModel* contactsModel;
+    QTableView* contactsTable;
     QLineEdit* searchEdit;
+    QCompleter* lastNameCompleter;
+    QStringListModel* lastNameModel;
+    // Подсказки запрашиваются после паузы в наборе, не больше одного запроса сразу
+    QTimer* completionTimer;
+    QFutureWatcher<QStringList>* completionWatcher;
+    QString completionText;         // строка, для которой собираются подсказки
+    bool completionPending = false; // строку изменили, пока шел запрос
     QPushButton* addButton;
     QPushButton* editButton;
     QPushButton* deleteButton;
 
     void setupUI();
+    int selectedContactId() const;
 };
\ No newline at end of file
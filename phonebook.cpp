@@ -1,14 +1,8 @@
 #include "phonebook.h"
 #include <algorithm>
-#include <cctype>
 #include <QDebug>
-
-std::string PhoneBook::toLower(const std::string& str) const {
-    std::string result = str;
-    std::transform(result.begin(), result.end(), result.begin(), 
-                  [](unsigned char c){ return std::tolower(c); });
-    return result;
-}
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrent>
 
 PhoneBook::PhoneBook(std::unique_ptr<IStorage> storage_, QObject *parent)
     : QObject(parent)
@@ -16,34 +10,277 @@ PhoneBook::PhoneBook(std::unique_ptr<IStorage> storage_, QObject *parent)
 {
 }
 
+PhoneBook::~PhoneBook() {
+    // Фоновые поиски обращаются к storage - дожидаемся их до его удаления
+    cancelSearches();
+    for (auto& search : searches) {
+        search.waitForFinished();
+    }
+}
+
 bool PhoneBook::addContact(Contact&& contact) {
-    if (!storage->addContact(contact)) {
-        lastError = storage->getLastError();
-        return false;
+    // Добавляем через пакетный метод: он возвращает присвоенный хранилищем id
+    std::vector<Contact> batch;
+    batch.push_back(std::move(contact));
+    {
+        QMutexLocker locker(&mutex);
+        if (!storage->addContacts(batch).front()) {
+            lastError = storage->getLastError();
+            return false;
+        }
+        invalidateSearches();
     }
+    emit contactAdded(batch.front().getId());
     return true;
 }
 
 bool PhoneBook::updateContact(int id, const Contact& contact) {
-    if (!storage->updateContact(id, contact)) {
-        lastError = storage->getLastError();
-        return false;
+    {
+        QMutexLocker locker(&mutex);
+        if (!storage->updateContact(id, contact)) {
+            lastError = storage->getLastError();
+            return false;
+        }
+        invalidateSearches();
     }
+    emit contactUpdated(id);
     return true;
 }
 
 bool PhoneBook::deleteContact(int id) {
-    if (!storage->deleteContact(id)) {
-        lastError = storage->getLastError();
-        return false;
+    {
+        QMutexLocker locker(&mutex);
+        if (!storage->deleteContact(id)) {
+            lastError = storage->getLastError();
+            return false;
+        }
+        invalidateSearches();
     }
+    emit contactRemoved(id);
     return true;
 }
 
+std::vector<bool> PhoneBook::addContacts(std::vector<Contact>& contacts) {
+    QMutexLocker locker(&mutex);
+    std::vector<bool> results = storage->addContacts(contacts);
+    invalidateSearches();
+    QVector<int> changed;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i]) {
+            changed.append(contacts[i].getId());
+        }
+    }
+    finishBatch(changed, static_cast<int>(results.size()), locker);
+    return results;
+}
+
+std::vector<bool> PhoneBook::updateContacts(const std::vector<Contact>& contacts) {
+    QMutexLocker locker(&mutex);
+    std::vector<bool> results = storage->updateContacts(contacts);
+    invalidateSearches();
+    QVector<int> changed;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i]) {
+            changed.append(contacts[i].getId());
+        }
+    }
+    finishBatch(changed, static_cast<int>(results.size()), locker);
+    return results;
+}
+
+std::vector<bool> PhoneBook::deleteContacts(const std::vector<int>& ids) {
+    QMutexLocker locker(&mutex);
+    std::vector<bool> results = storage->deleteContacts(ids);
+    invalidateSearches();
+    QVector<int> changed;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (results[i]) {
+            changed.append(ids[i]);
+        }
+    }
+    finishBatch(changed, static_cast<int>(results.size()), locker);
+    return results;
+}
+
+void PhoneBook::finishBatch(const QVector<int>& changed, int total, QMutexLocker& locker) {
+    if (changed.size() != total) {
+        lastError = storage->getLastError();
+    }
+    // Обработчики сигнала читают книгу - отпускаем мьютекс до emit
+    locker.unlock();
+    if (!changed.isEmpty()) {
+        emit contactsChanged(changed);
+    }
+}
+
+bool PhoneBook::getContact(int id, Contact& contact) const {
+    QMutexLocker locker(&mutex);
+    return storage->getContact(id, contact);
+}
+
 std::vector<Contact> PhoneBook::getContacts() const {
+    QMutexLocker locker(&mutex);
     return storage->getAllContacts();
 }
 
 std::vector<Contact> PhoneBook::findContacts(const QString& query) const {
-    return storage->findContacts(query);
+    QMutexLocker locker(&mutex);
+    std::vector<Contact> result;
+    searchLocked(query, []() { return false; },
+                 [&result](const Contact& contact) { result.push_back(contact); });
+    return result;
+}
+
+std::pmr::vector<Contact> PhoneBook::getContacts(std::pmr::memory_resource* arena) const {
+    std::pmr::vector<Contact> result(arena);
+    QMutexLocker locker(&mutex);
+    storage->forEachContact([&result](const Contact& contact) {
+        result.push_back(contact);
+        return true;
+    });
+    return result;
+}
+
+std::pmr::vector<Contact> PhoneBook::findContacts(const QString& query,
+                                                  std::pmr::memory_resource* arena) const {
+    std::pmr::vector<Contact> result(arena);
+    QMutexLocker locker(&mutex);
+    searchLocked(query, []() { return false; },
+                 [&result](const Contact& contact) { result.push_back(contact); });
+    return result;
+}
+
+std::vector<Contact> PhoneBook::getContactsPage(const ContactPageKey& after, int limit) const {
+    QMutexLocker locker(&mutex);
+    return storage->getContactsPage(after, limit);
+}
+
+bool PhoneBook::forEachContact(const ContactVisitor& visitor) const {
+    QMutexLocker locker(&mutex);
+    return storage->forEachContact(visitor);
+}
+
+bool PhoneBook::forEachMatch(const QString& query, const ContactVisitor& visitor) const {
+    QMutexLocker locker(&mutex);
+    return storage->forEachMatch(query, visitor);
+}
+
+std::vector<std::string> PhoneBook::completeLastName(const QString& prefix, int limit) const {
+    QMutexLocker locker(&mutex);
+    return storage->completeLastName(prefix, limit);
+}
+
+std::vector<Contact> PhoneBook::findByLastNamePrefix(const QString& prefix, int limit) const {
+    QMutexLocker locker(&mutex);
+    return storage->findByLastNamePrefix(prefix, limit);
+}
+
+QFuture<std::vector<Contact>> PhoneBook::findContactsAsync(const QString& query) {
+    quint64 generation = ++searchGeneration;
+
+    forgetFinishedSearches();
+
+    QFuture<std::vector<Contact>> search = QtConcurrent::run([this, query, generation]() {
+        std::vector<Contact> result;
+        {
+            QMutexLocker locker(&mutex);
+            // Поиск прерывается, как только начался более новый
+            searchLocked(query, [this, generation]() {
+                return searchGeneration.load(std::memory_order_relaxed) != generation;
+            }, [&result](const Contact& contact) { result.push_back(contact); });
+        }
+
+        std::sort(result.begin(), result.end(), [](const Contact& a, const Contact& b) {
+            int cmp = a.getLastName().compare(b.getLastName());
+            return cmp < 0 || (cmp == 0 && a.getId() < b.getId());
+        });
+        return result;
+    });
+    searches.append(QFuture<void>(search));
+    return search;
+}
+
+void PhoneBook::cancelSearches() {
+    ++searchGeneration;
+}
+
+QFuture<QStringList> PhoneBook::completeLastNameAsync(const QString& prefix, int limit) {
+    forgetFinishedSearches();
+
+    QFuture<QStringList> completion = QtConcurrent::run([this, prefix, limit]() {
+        QStringList names;
+        for (const auto& name : completeLastName(prefix, limit)) {
+            names << QString::fromStdString(name);
+        }
+        return names;
+    });
+    searches.append(QFuture<void>(completion));
+    return completion;
+}
+
+void PhoneBook::forgetFinishedSearches() {
+    // Завершенные задачи больше не нужно ждать в деструкторе
+    searches.erase(std::remove_if(searches.begin(), searches.end(),
+        [](const QFuture<void>& search) { return search.isFinished(); }),
+        searches.end());
+}
+
+void PhoneBook::searchLocked(const QString& query, const std::function<bool()>& cancelled,
+                             const std::function<void(const Contact&)>& collect) const {
+    if (cancelled()) {
+        return;
+    }
+
+    std::vector<int> ids;
+    bool completed = true;
+    const CachedSearch* base = findNarrowableSearch(query);
+    if (base) {
+        // Запрос сужает уже выполненный: перепроверяем только его результат
+        Contact contact;
+        for (int id : base->ids) {
+            if (cancelled()) {
+                completed = false;
+                break;
+            }
+            if (storage->getContact(id, contact) && storage->matchesQuery(contact, query)) {
+                ids.push_back(id);
+                collect(contact);
+            }
+        }
+    } else {
+        completed = storage->forEachMatch(query, [&](const Contact& contact) {
+            if (cancelled()) {
+                return false;
+            }
+            ids.push_back(contact.getId());
+            collect(contact);
+            return true;
+        });
+    }
+
+    // Прерванный или неудачный поиск неполон - его не запоминаем
+    if (completed && !query.isEmpty()) {
+        if (searchCache.size() >= kMaxCachedSearches) {
+            searchCache.removeFirst();
+        }
+        searchCache.append({query, storageGeneration, std::move(ids)});
+    }
+}
+
+const PhoneBook::CachedSearch* PhoneBook::findNarrowableSearch(const QString& query) const {
+    // Из подходящих берем самый длинный запрос - у него самый короткий результат
+    const CachedSearch* best = nullptr;
+    for (const auto& cached : searchCache) {
+        if (cached.generation == storageGeneration &&
+            storage->narrows(cached.query, query) &&
+            (!best || cached.query.size() > best->query.size())) {
+            best = &cached;
+        }
+    }
+    return best;
+}
+
+void PhoneBook::invalidateSearches() {
+    ++storageGeneration;
+    searchCache.clear();
 }
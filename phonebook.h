@@ -1,7 +1,15 @@
 #pragma once
 #include <QObject>
+#include <QVector>
+#include <QFuture>
+#include <QList>
+#include <QStringList>
+#include <QMutex>
+#include <atomic>
+#include <functional>
 #include <vector>
 #include <memory>
+#include <memory_resource>
 #include "contact.h"
 #include "istorage.h"
 
@@ -10,17 +18,69 @@ class PhoneBook : public QObject {
 
 public:
     explicit PhoneBook(std::unique_ptr<IStorage> storage, QObject *parent = nullptr);
-    ~PhoneBook() = default;
+    ~PhoneBook();
     
     bool addContact(Contact&& contact);
     bool updateContact(int id, const Contact& contact);
     bool deleteContact(int id);
+    std::vector<bool> addContacts(std::vector<Contact>& contacts);
+    std::vector<bool> updateContacts(const std::vector<Contact>& contacts);
+    std::vector<bool> deleteContacts(const std::vector<int>& ids);
+    bool getContact(int id, Contact& contact) const;
     std::vector<Contact> getContacts() const;
     std::vector<Contact> findContacts(const QString& query) const;
+    // То же, но весь результат вместе со строками контактов размещается
+    // в arena (например, std::pmr::monotonic_buffer_resource) и освобождается
+    // вместе с ней. Арена должна пережить результат
+    std::pmr::vector<Contact> getContacts(std::pmr::memory_resource* arena) const;
+    std::pmr::vector<Contact> findContacts(const QString& query, std::pmr::memory_resource* arena) const;
+    std::vector<Contact> getContactsPage(const ContactPageKey& after, int limit) const;
+    bool forEachContact(const ContactVisitor& visitor) const;
+    bool forEachMatch(const QString& query, const ContactVisitor& visitor) const;
+    std::vector<std::string> completeLastName(const QString& prefix, int limit) const;
+    std::vector<Contact> findByLastNamePrefix(const QString& prefix, int limit) const;
     QString getLastError() const { return lastError; }
 
+    // Поиск в фоновом потоке; результат упорядочен по (фамилия, id).
+    // Новый вызов прерывает еще не завершенные поиски - их результат неполон.
+    QFuture<std::vector<Contact>> findContactsAsync(const QString& query);
+    void cancelSearches();
+    // Автодополнение фамилии в фоновом потоке
+    QFuture<QStringList> completeLastNameAsync(const QString& prefix, int limit);
+
+signals:
+    // Одиночные изменения
+    void contactAdded(int id);
+    void contactUpdated(int id);
+    void contactRemoved(int id);
+    // Пакетные изменения: id всех успешно добавленных, измененных или удаленных контактов
+    void contactsChanged(const QVector<int>& ids);
+
 private:
     std::unique_ptr<IStorage> storage;
     QString lastError;
-    std::string toLower(const std::string& str) const;
+    // Хранилища не потокобезопасны: все обращения к storage идут под мьютексом.
+    // Обработчики forEach* вызываются под ним и не должны обращаться к PhoneBook.
+    mutable QMutex mutex;
+    std::atomic<quint64> searchGeneration{0};
+    QList<QFuture<void>> searches;   // фоновые задачи, которых ждет деструктор
+
+    // Кэш последних результатов поиска (id в порядке выдачи хранилища).
+    // Удлиненный запрос отвечается фильтрацией кэшированного результата;
+    // любое изменение книги увеличивает storageGeneration и сбрасывает кэш.
+    struct CachedSearch {
+        QString query;
+        quint64 generation;
+        std::vector<int> ids;
+    };
+    static constexpr int kMaxCachedSearches = 8;
+    mutable QList<CachedSearch> searchCache;
+    quint64 storageGeneration = 0;
+
+    void searchLocked(const QString& query, const std::function<bool()>& cancelled,
+                      const std::function<void(const Contact&)>& collect) const;
+    const CachedSearch* findNarrowableSearch(const QString& query) const;
+    void invalidateSearches();
+    void forgetFinishedSearches();
+    void finishBatch(const QVector<int>& changed, int total, QMutexLocker& locker);
 };
@@ -0,0 +1,298 @@
+#include "phonekernel.h"
+#include "validation.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PHONEKERNEL_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr quint64 kCountryCode = 70000000000ULL; // 7 и десять нулей
+
+// Скалярный путь: та же проверка, что у PhoneNumber, затем цифры после префикса
+bool normalizeScalar(std::string_view number, quint64& e164) {
+    e164 = 0;
+    if (!Validation::isPhoneNumber(number)) {
+        return false;
+    }
+    std::string_view text = Validation::trimmed(number);
+    quint64 value = 0;
+    bool prefix = true;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        int digit = Validation::digitValue(Validation::decode(text, pos));
+        if (digit < 0) {
+            continue;
+        }
+        // Первая цифра - 7 из +7 или 8
+        if (prefix) {
+            prefix = false;
+        } else {
+            value = value * 10 + digit;
+        }
+    }
+    e164 = kCountryCode + value;
+    return true;
+}
+
+#ifdef PHONEKERNEL_X86
+
+constexpr size_t kBlockSize = 32;
+
+// Маски классов байтов блока: бит i относится к байту i
+struct ByteClasses {
+    quint32 digits;
+    quint32 spaces;   // \t..\r и пробел
+    quint32 other;    // не цифра, не пробел и не +()-
+    quint32 nonAscii;
+};
+
+using Classifier = ByteClasses (*)(const unsigned char* block);
+
+// PCMPESTRM сравнивает 16 байтов сразу со всеми диапазонами или символами набора
+__attribute__((target("sse4.2")))
+ByteClasses classifySse42(const unsigned char* block) {
+    const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    const __m128i digitRange = _mm_setr_epi8('0', '9', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i spaceRanges = _mm_setr_epi8('\t', '\r', ' ', ' ', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i punctuation = _mm_setr_epi8('+', '(', ')', '-', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    constexpr int kRanges = _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_BIT_MASK;
+    constexpr int kAny = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+
+    quint32 digits = quint32(_mm_cvtsi128_si32(_mm_cmpestrm(digitRange, 2, data, 16, kRanges)));
+    quint32 spaces = quint32(_mm_cvtsi128_si32(_mm_cmpestrm(spaceRanges, 4, data, 16, kRanges)));
+    quint32 punct = quint32(_mm_cvtsi128_si32(_mm_cmpestrm(punctuation, 4, data, 16, kAny)));
+    quint32 nonAscii = quint32(_mm_movemask_epi8(data));
+    return {digits, spaces, ~(digits | spaces | punct) & 0xFFFF, nonAscii};
+}
+
+// Байты не ASCII при знаковом сравнении отрицательны и не попадают ни в один диапазон
+__attribute__((target("avx2")))
+ByteClasses classifyAvx2(const unsigned char* block) {
+    const __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    const __m256i digits = _mm256_and_si256(_mm256_cmpgt_epi8(data, _mm256_set1_epi8('0' - 1)),
+                                            _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), data));
+    const __m256i controls = _mm256_and_si256(_mm256_cmpgt_epi8(data, _mm256_set1_epi8('\t' - 1)),
+                                              _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), data));
+    const __m256i spaces = _mm256_or_si256(controls, _mm256_cmpeq_epi8(data, _mm256_set1_epi8(' ')));
+    const __m256i punct = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(data, _mm256_set1_epi8('+')),
+                        _mm256_cmpeq_epi8(data, _mm256_set1_epi8('('))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(data, _mm256_set1_epi8(')')),
+                        _mm256_cmpeq_epi8(data, _mm256_set1_epi8('-'))));
+
+    quint32 digitMask = quint32(_mm256_movemask_epi8(digits));
+    quint32 spaceMask = quint32(_mm256_movemask_epi8(spaces));
+    quint32 punctMask = quint32(_mm256_movemask_epi8(punct));
+    return {digitMask, spaceMask, ~(digitMask | spaceMask | punctMask),
+            quint32(_mm256_movemask_epi8(data))};
+}
+
+// Биты from..to-1, 0 <= from <= to < 32
+quint32 bitsBetween(int from, int to) {
+    return ((1u << to) - 1) & ~((1u << from) - 1);
+}
+
+// \)?[-\s]? между from и to (если bracket) или [-\s]?
+bool separatorsBetween(const unsigned char* s, const ByteClasses& classes, int from, int to, bool bracket) {
+    if (bracket && from < to && s[from] == ')') {
+        ++from;
+    }
+    if (from < to && (s[from] == '-' || ((classes.spaces >> from) & 1))) {
+        ++from;
+    }
+    return from == to;
+}
+
+// Разбор ASCII-номера по маскам его блока (length <= 32). Выражение
+// ^(\+7|8)\s*\(?\d{3}\)?[-\s]?\d{3}[-\s]?\d{2}[-\s]?\d{2}$ после trimmed:
+// ровно 11 цифр, первая - префикс, остальные идут группами 3-3-2-2,
+// а между группами стоят только разрешенные разделители
+bool parseBlock(const unsigned char* s, size_t length, const ByteClasses& classes, quint64& e164) {
+    const quint32 all = length == kBlockSize ? ~0u : (1u << length) - 1;
+    if (classes.other & all) {
+        return false;
+    }
+    const quint32 content = all & ~classes.spaces;
+    const quint32 digits = classes.digits & all;
+    if (content == 0 || __builtin_popcount(digits) != 11) {
+        return false;
+    }
+    int prefix = __builtin_ctz(content);
+    const int last = 31 - __builtin_clz(content);
+
+    if (s[prefix] == '+') {
+        if (prefix == last || s[++prefix] != '7') {
+            return false;
+        }
+    } else if (s[prefix] != '8') {
+        return false;
+    }
+
+    // Позиции десяти цифр после префикса
+    quint32 rest = digits & ~((2u << prefix) - 1);
+    int at[10];
+    quint64 value = 0;
+    for (int i = 0; i < 10; ++i) {
+        if (rest == 0) {
+            return false;
+        }
+        at[i] = __builtin_ctz(rest);
+        rest &= rest - 1;
+        value = value * 10 + (s[at[i]] - '0');
+    }
+    if (at[2] - at[0] != 2 || at[5] - at[3] != 2 || at[7] - at[6] != 1 ||
+        at[9] - at[8] != 1 || at[9] != last) {
+        return false;
+    }
+
+    // \s*\(? перед первой группой
+    int open = at[0];
+    if (open > prefix + 1 && s[open - 1] == '(') {
+        --open;
+    }
+    if (bitsBetween(prefix + 1, open) & ~classes.spaces) {
+        return false;
+    }
+    if (!separatorsBetween(s, classes, at[2] + 1, at[3], true) ||
+        !separatorsBetween(s, classes, at[5] + 1, at[6], false) ||
+        !separatorsBetween(s, classes, at[7] + 1, at[8], false)) {
+        return false;
+    }
+    e164 = kCountryCode + value;
+    return true;
+}
+
+#endif // PHONEKERNEL_X86
+
+struct Kernel {
+    const char* name;
+#ifdef PHONEKERNEL_X86
+    size_t width;          // самый длинный номер для векторного пути
+    Classifier classify;   // nullptr - только скалярный путь
+#endif
+};
+
+Kernel kernelFor(PhoneKernel::Implementation implementation) {
+#ifdef PHONEKERNEL_X86
+    switch (implementation) {
+    case PhoneKernel::Implementation::Avx2:
+        return {"avx2", 32, classifyAvx2};
+    case PhoneKernel::Implementation::Sse42:
+        return {"sse4.2", 16, classifySse42};
+    case PhoneKernel::Implementation::Scalar:
+        break;
+    }
+    return {"scalar", 0, nullptr};
+#else
+    Q_UNUSED(implementation);
+    return {"scalar"};
+#endif
+}
+
+Kernel detectKernel() {
+    for (auto implementation : {PhoneKernel::Implementation::Avx2, PhoneKernel::Implementation::Sse42}) {
+        if (PhoneKernel::isSupported(implementation)) {
+            return kernelFor(implementation);
+        }
+    }
+    return kernelFor(PhoneKernel::Implementation::Scalar);
+}
+
+const Kernel& kernel() {
+    static const Kernel selected = detectKernel();
+    return selected;
+}
+
+bool normalizeWith(const Kernel& kernel, std::string_view number, quint64& e164) {
+#ifdef PHONEKERNEL_X86
+    if (kernel.classify && number.size() <= kernel.width) {
+        // Хвост блока - нули: они не цифры и не пробелы и отсекаются маской длины
+        alignas(kBlockSize) unsigned char block[kBlockSize] = {};
+        std::memcpy(block, number.data(), number.size());
+        ByteClasses classes = kernel.classify(block);
+        // Пробелы и цифры вне ASCII проверяет только скалярный путь
+        if (classes.nonAscii == 0) {
+            e164 = 0;
+            return parseBlock(block, number.size(), classes, e164);
+        }
+    }
+#else
+    Q_UNUSED(kernel);
+#endif
+    return normalizeScalar(number, e164);
+}
+
+PhoneKernel::Result normalizeBuffer(const Kernel& selected, std::string_view buffer) {
+    PhoneKernel::Result result;
+    size_t count = std::count(buffer.begin(), buffer.end(), '\n') + 1;
+    result.numbers.reserve(count);
+    result.validMask.reserve((count + 63) / 64);
+
+    size_t pos = 0;
+    while (pos < buffer.size()) {
+        size_t end = buffer.find('\n', pos);
+        if (end == std::string_view::npos) {
+            end = buffer.size();
+        }
+        quint64 e164;
+        bool valid = normalizeWith(selected, buffer.substr(pos, end - pos), e164);
+
+        size_t index = result.numbers.size();
+        if (index % 64 == 0) {
+            result.validMask.push_back(0);
+        }
+        result.validMask.back() |= quint64(valid) << (index % 64);
+        result.numbers.push_back(e164);
+        pos = end + 1;
+    }
+    return result;
+}
+
+} // namespace
+
+PhoneKernel::Result PhoneKernel::normalize(std::string_view buffer) {
+    return normalizeBuffer(kernel(), buffer);
+}
+
+bool PhoneKernel::normalize(std::string_view number, quint64& e164) {
+    return normalizeWith(kernel(), number, e164);
+}
+
+bool PhoneKernel::isSupported(Implementation implementation) {
+#ifdef PHONEKERNEL_X86
+    __builtin_cpu_init();
+    switch (implementation) {
+    case Implementation::Avx2:
+        return __builtin_cpu_supports("avx2");
+    case Implementation::Sse42:
+        return __builtin_cpu_supports("sse4.2");
+    case Implementation::Scalar:
+        return true;
+    }
+    return false;
+#else
+    return implementation == Implementation::Scalar;
+#endif
+}
+
+PhoneKernel::Result PhoneKernel::normalize(std::string_view buffer, Implementation implementation) {
+    return normalizeBuffer(kernelFor(isSupported(implementation) ? implementation : Implementation::Scalar),
+                           buffer);
+}
+
+bool PhoneKernel::normalize(std::string_view number, quint64& e164, Implementation implementation) {
+    return normalizeWith(kernelFor(isSupported(implementation) ? implementation : Implementation::Scalar),
+                         number, e164);
+}
+
+std::string PhoneKernel::format(quint64 e164) {
+    return "+" + std::to_string(e164);
+}
+
+const char* PhoneKernel::implementation() {
+    return kernel().name;
+}
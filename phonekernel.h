@@ -0,0 +1,42 @@
+#pragma once
+#include <QtGlobal>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Пакетная нормализация и проверка телефонных номеров (импорт больших выгрузок).
+// Номера идут в одном буфере через '\n' (\r перед ним - пробел и обрезается).
+// Номер действителен по тем же правилам, что Validation::isPhoneNumber, и
+// сводится к E.164 без '+': 7XXXXXXXXXX, хранится как число.
+// Короткие ASCII-номера разбираются векторно: классы байтов (цифра, пробел,
+// +()-) получаются битовыми масками за одну загрузку, позиции цифр - из маски.
+// Реализация (AVX2, SSE4.2 или скалярная) выбирается один раз при первом вызове
+// по возможностям процессора. Остальные номера (длинные, не ASCII) идут
+// скалярным путем, так что результат от выбора реализации не зависит.
+class PhoneKernel {
+public:
+    enum class Implementation { Scalar, Sse42, Avx2 };
+
+    struct Result {
+        std::vector<quint64> numbers;   // E.164, 0 - номер недействителен
+        std::vector<quint64> validMask; // бит i - номер i действителен
+
+        size_t size() const { return numbers.size(); }
+        bool isValid(size_t i) const { return (validMask[i / 64] >> (i % 64)) & 1; }
+    };
+
+    static Result normalize(std::string_view buffer);
+    // Один номер; false, если он недействителен
+    static bool normalize(std::string_view number, quint64& e164);
+
+    // Явный выбор реализации (тесты и замеры). Неподдерживаемая процессором
+    // реализация заменяется скалярной
+    static bool isSupported(Implementation implementation);
+    static Result normalize(std::string_view buffer, Implementation implementation);
+    static bool normalize(std::string_view number, quint64& e164, Implementation implementation);
+
+    // +7XXXXXXXXXX
+    static std::string format(quint64 e164);
+    // "avx2", "sse4.2" или "scalar"
+    static const char* implementation();
+};
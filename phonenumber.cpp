@@ -1,47 +1,40 @@
 #include "phonenumber.h"
+#include "validation.h"
 #include <QRegExp>
 
-PhoneNumber::PhoneNumber(const std::string& num, const std::string& t)
-    : number(num), type(t) {}
+PhoneNumber::PhoneNumber(std::string_view num, std::string_view t)
+    : PhoneNumber(num, t, allocator_type()) {}
+
+PhoneNumber::PhoneNumber(std::string_view num, std::string_view t, const allocator_type& alloc)
+    : number(num, alloc), type(t, alloc) {}
 
 bool PhoneNumber::isValid() const {
     return validatePhoneNumber(number);
 }
 
-bool PhoneNumber::validatePhoneNumber(const std::string& phone) {
-    if (phone.empty()) return false;
-    
-    static const QRegExp phoneRegex(
-        "^(\\+7|8)\\s*\\(?(\\d{3})\\)?[-\\s]?(\\d{3})[-\\s]?(\\d{2})[-\\s]?(\\d{2})$"
-    );
-    
-    QString qPhone = QString::fromStdString(phone).trimmed();
-    return phoneRegex.exactMatch(qPhone);
-}
-
-std::string PhoneNumber::getNumber() const {
-    return number;
+bool PhoneNumber::validatePhoneNumber(std::string_view phone) {
+    return Validation::isPhoneNumber(phone);
 }
 
-std::string PhoneNumber::getType() const {
-    return type;
+bool PhoneNumber::isValidNumber(std::string_view num) {
+    return Validation::isStrictPhoneNumber(num);
 }
 
-void PhoneNumber::setNumber(const std::string& newNumber) {
+void PhoneNumber::setNumber(std::string_view newNumber) {
     // Форматируем номер телефона в единый формат
-    QString formatted = QString::fromStdString(newNumber)
+    QString formatted = toQString(newNumber)
         .remove(QRegExp("[\\s-]"))  // Удаляем пробелы и дефисы
         .replace(QRegExp("^8"), "+7"); // Заменяем 8 на +7
     
     number = formatted.toStdString();
 }
 
-void PhoneNumber::setType(const std::string& newType) {
+void PhoneNumber::setType(std::string_view newType) {
     type = newType;
 }
 
 std::string PhoneNumber::getFormattedNumber() const {
-    std::string formatted = number;
+    std::string formatted(number);
     // Удаляем все существующие дефисы
     formatted.erase(std::remove(formatted.begin(), formatted.end(), '-'), formatted.end());
     
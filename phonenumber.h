@@ -1,31 +1,63 @@
 #pragma once
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <QRegExp>
-#include <QDebug>
+#include "instrumentation.h"
 
+// Поля контактов хранятся в UTF-8; в QString переводятся только на границе
+// с Qt (виджеты, модель, JSON, SQL) - без промежуточной std::string
+inline QString toQString(std::string_view text) {
+    return QString::fromUtf8(text.data(), int(text.size()));
+}
+
+// Обратное преобразование для сеттеров: setLastName(Utf8(text)).
+// Байты живут во временном объекте до конца выражения - этого хватает,
+// чтобы сеттер скопировал их в контакт
+class Utf8 {
+public:
+    explicit Utf8(const QString& text) : m_bytes(text.toUtf8()) {}
+    operator std::string_view() const {
+        return std::string_view(m_bytes.constData(), size_t(m_bytes.size()));
+    }
+
+private:
+    QByteArray m_bytes;
+};
+
+// Как и Contact, поддерживает std::pmr: внутри pmr::vector контакта
+// строки номера размещаются в ресурсе контакта
 class PhoneNumber {
+public:
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
 private:
-    std::string number;
-    std::string type; // "home", "work", "mobile"
+    std::pmr::string number;
+    std::pmr::string type; // "home", "work", "mobile"
     
-    inline static int copyCount = 0;
-    inline static int moveCount = 0;
+    // Счетчики работают при PHONEBOOK_LIFETIME_STATS
+    inline static LifetimeCounter copyCount;
+    inline static LifetimeCounter moveCount;
 
 public:
-    PhoneNumber(const std::string& num = "", const std::string& t = "мобильный");
+    PhoneNumber(std::string_view num = "", std::string_view t = "мобильный");
+    PhoneNumber(std::string_view num, std::string_view t, const allocator_type& alloc);
+    explicit PhoneNumber(const allocator_type& alloc) : PhoneNumber("", "мобильный", alloc) {}
     bool isValid() const;
-    std::string getNumber() const;
-    std::string getType() const;
+    // Ссылаются на строки номера и живут, пока номер не изменен
+    std::string_view getNumber() const { return number; }
+    std::string_view getType() const { return type; }
     std::string getFormattedNumber() const;
     bool isValidType(const std::string& t) const;
     
     // Конструктор копирования
-    PhoneNumber(const PhoneNumber& other) 
-        : number(other.number)
-        , type(other.type) 
+    PhoneNumber(const PhoneNumber& other) : PhoneNumber(other, allocator_type()) {}
+
+    PhoneNumber(const PhoneNumber& other, const allocator_type& alloc)
+        : number(other.number, alloc)
+        , type(other.type, alloc)
     {
-        ++copyCount;
-        qDebug() << "PhoneNumber copy constructor. Total copies:" << copyCount;
+        copyCount.increment();
     }
     
     // Оператор присваивания копированием
@@ -33,8 +65,7 @@ public:
         if (this != &other) {
             number = other.number;
             type = other.type;
-            ++copyCount;
-            qDebug() << "PhoneNumber copy assignment. Total copies:" << copyCount;
+            copyCount.increment();
         }
         return *this;
     }
@@ -44,40 +75,39 @@ public:
         : number(std::move(other.number))
         , type(std::move(other.type))
     {
-        ++moveCount;
-        qDebug() << "PhoneNumber move constructor. Total moves:" << moveCount;
+        moveCount.increment();
+    }
+
+    PhoneNumber(PhoneNumber&& other, const allocator_type& alloc)
+        : number(std::move(other.number), alloc)
+        , type(std::move(other.type), alloc)
+    {
+        moveCount.increment();
     }
     
-    // Оператор присваивания перемещением
-    PhoneNumber& operator=(PhoneNumber&& other) noexcept {
+    // Оператор присваивания перемещением (при разных ресурсах - копирование)
+    PhoneNumber& operator=(PhoneNumber&& other) {
         if (this != &other) {
             number = std::move(other.number);
             type = std::move(other.type);
-            ++moveCount;
-            qDebug() << "PhoneNumber move assignment. Total moves:" << moveCount;
+            moveCount.increment();
         }
         return *this;
     }
     
     // Валидация
-    static bool isValidNumber(const std::string& num) {
-        QString qNum = QString::fromStdString(num).trimmed();
-        
-        // Поддерживаемые форматы:
-        // +78121234567
-        // 88121234567
-        // +7(812)1234567
-        // 8(812)1234567
-        // +7(812)123-45-67
-        // 8(812)123-45-67
-        
-        QRegExp phoneRegex("^(\\+7|8)(\\(\\d{3}\\)|\\d{3})(\\d{7}|\\d{3}-\\d{2}-\\d{2})$");
-        return phoneRegex.exactMatch(qNum);
-    }
+    // Поддерживаемые форматы:
+    // +78121234567
+    // 88121234567
+    // +7(812)1234567
+    // 8(812)1234567
+    // +7(812)123-45-67
+    // 8(812)123-45-67
+    static bool isValidNumber(std::string_view num);
     
     // Нормализация номера (приведение к единому формату)
-    static std::string normalizeNumber(const std::string& num) {
-        QString qNum = QString::fromStdString(num).trimmed();
+    static std::string normalizeNumber(std::string_view num) {
+        QString qNum = toQString(num).trimmed();
         
         // Удаляем все не цифры, кроме +
         QString normalized;
@@ -96,16 +126,18 @@ public:
     }
     
     // Геттеры и сеттеры
-    void setNumber(const std::string& newNumber);
-    void setType(const std::string& newType);
+    void setNumber(std::string_view newNumber);
+    void setType(std::string_view newType);
     
     // Статистика
-    static int getCopyCount() { return copyCount; }
-    static int getMoveCount() { return moveCount; }
+    static int getCopyCount() { return copyCount.value(); }
+    static int getMoveCount() { return moveCount.value(); }
     static void resetCounters() {
-        copyCount = 0;
-        moveCount = 0;
+        copyCount.reset();
+        moveCount.reset();
     }
     
-    static bool validatePhoneNumber(const std::string& phone);
+    static bool validatePhoneNumber(std::string_view phone);
+
+    allocator_type get_allocator() const { return number.get_allocator(); }
 }; 
\ No newline at end of file
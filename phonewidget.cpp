@@ -32,14 +32,14 @@ PhoneNumber PhoneWidget::getPhoneNumber() const {
     }
     
     return PhoneNumber(
-        number.toStdString(),
-        typeCombo->currentText().toStdString()
+        Utf8(number),
+        Utf8(typeCombo->currentText())
     );
 }
 
 void PhoneWidget::setPhoneNumber(const PhoneNumber& number) {
-    numberEdit->setText(QString::fromStdString(number.getNumber()));
-    typeCombo->setCurrentText(QString::fromStdString(number.getType()));
+    numberEdit->setText(toQString(number.getNumber()));
+    typeCombo->setCurrentText(toQString(number.getType()));
 }
 
 void PhoneWidget::clear() {
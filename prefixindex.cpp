@@ -0,0 +1,53 @@
+#include "prefixindex.h"
+#include "searchindex.h"
+#include <climits>
+
+namespace {
+
+bool hasPrefix(const std::string& key, const std::string& prefix) {
+    return key.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+void PrefixIndex::insert(int id, std::string_view lastName) {
+    remove(id);
+    std::string key = SearchIndex::fold(toQString(lastName));
+    m_entries.emplace(Key(key, id), lastName);
+    m_keys.emplace(id, std::move(key));
+}
+
+void PrefixIndex::remove(int id) {
+    auto key = m_keys.find(id);
+    if (key == m_keys.end()) {
+        return;
+    }
+    m_entries.erase(Key(key->second, id));
+    m_keys.erase(key);
+}
+
+void PrefixIndex::clear() {
+    m_entries.clear();
+    m_keys.clear();
+}
+
+std::vector<std::string> PrefixIndex::complete(const std::string& foldedPrefix, int limit) const {
+    std::vector<std::string> names;
+    auto it = m_entries.lower_bound(Key(foldedPrefix, INT_MIN));
+    while (it != m_entries.end() && int(names.size()) < limit && hasPrefix(it->first.first, foldedPrefix)) {
+        names.push_back(it->second);
+        // Однофамильцев пропускаем одним переходом к следующему ключу
+        it = m_entries.upper_bound(Key(it->first.first, INT_MAX));
+    }
+    return names;
+}
+
+std::vector<int> PrefixIndex::range(const std::string& foldedPrefix, int limit) const {
+    std::vector<int> ids;
+    for (auto it = m_entries.lower_bound(Key(foldedPrefix, INT_MIN));
+         it != m_entries.end() && int(ids.size()) < limit && hasPrefix(it->first.first, foldedPrefix);
+         ++it) {
+        ids.push_back(it->first.second);
+    }
+    return ids;
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Отсортированный индекс фамилий для автодополнения.
+// Ключ - фамилия, приведенная через SearchIndex::fold, поэтому регистр
+// не важен и ё совпадает с е. Записи упорядочены по (ключ, id): все фамилии
+// с общим префиксом идут подряд, и выборка стоит O(log N + k).
+class PrefixIndex {
+public:
+    void insert(int id, std::string_view lastName);
+    void remove(int id);
+    void clear();
+
+    // До limit различных фамилий, ключ которых начинается с foldedPrefix
+    std::vector<std::string> complete(const std::string& foldedPrefix, int limit) const;
+    // До limit id контактов с такими фамилиями в порядке (ключ, id)
+    std::vector<int> range(const std::string& foldedPrefix, int limit) const;
+
+private:
+    using Key = std::pair<std::string, int>;
+
+    std::map<Key, std::string> m_entries;     // (ключ, id) -> фамилия как есть
+    std::unordered_map<int, std::string> m_keys; // id -> ключ, для удаления
+};
@@ -0,0 +1,221 @@
+#include "searchindex.h"
+#include <algorithm>
+#include <iterator>
+
+std::string SearchIndex::searchKey(const Contact& contact) {
+    std::vector<std::string_view> phones;
+    for (const auto& phone : contact.getPhoneNumbers()) {
+        phones.push_back(phone.getNumber());
+    }
+    return searchKey(contact.getLastName(), contact.getFirstName(), contact.getMiddleName(),
+                     contact.getEmail(), contact.getAddress(), phones);
+}
+
+std::string SearchIndex::searchKey(std::string_view lastName, std::string_view firstName,
+                                   std::string_view middleName, std::string_view email,
+                                   std::string_view address, const std::vector<std::string_view>& phones) {
+    std::string key;
+    for (std::string_view field : {lastName, firstName, middleName, email, address}) {
+        key += fold(toQString(field));
+        key += '\n';
+    }
+    // Телефоны ищутся по цифрам: "+7 (812) 123" -> "7812123"
+    for (const auto& phone : phones) {
+        for (char c : phone) {
+            if (c >= '0' && c <= '9') {
+                key += c;
+            }
+        }
+        key += '\n';
+    }
+    return key;
+}
+
+std::string SearchIndex::fold(const QString& text) {
+    QString folded;
+    folded.reserve(text.size());
+    bool pendingSpace = false;
+    for (QChar c : text.toLower()) {
+        if (c.isSpace()) {
+            pendingSpace = !folded.isEmpty();
+            continue;
+        }
+        if (pendingSpace) {
+            folded += ' ';
+            pendingSpace = false;
+        }
+        folded += (c == QChar(0x0451)) ? QChar(0x0435) : c;  // ё -> е
+    }
+    return folded.toStdString();
+}
+
+std::vector<SearchIndex::Trigram> SearchIndex::trigrams(std::string_view text) {
+    std::vector<Trigram> result;
+    if (text.size() < 3) {
+        return result;
+    }
+    result.reserve(text.size() - 2);
+    for (size_t i = 0; i + 2 < text.size(); ++i) {
+        unsigned char a = text[i];
+        unsigned char b = text[i + 1];
+        unsigned char c = text[i + 2];
+        // Триграммы на стыке полей запросу не встретятся
+        if (a == '\n' || b == '\n' || c == '\n') {
+            continue;
+        }
+        result.push_back((Trigram(a) << 16) | (Trigram(b) << 8) | Trigram(c));
+    }
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+void SearchIndex::addPostings(int id, std::string_view key) {
+    for (Trigram trigram : trigrams(key)) {
+        std::vector<int>& ids = m_postings[trigram];
+        // id обычно растут, поэтому вставка чаще всего идет в конец
+        if (ids.empty() || ids.back() < id) {
+            ids.push_back(id);
+        } else {
+            auto it = std::lower_bound(ids.begin(), ids.end(), id);
+            if (it == ids.end() || *it != id) {
+                ids.insert(it, id);
+            }
+        }
+    }
+}
+
+void SearchIndex::removePostings(int id, std::string_view key) {
+    for (Trigram trigram : trigrams(key)) {
+        auto posting = m_postings.find(trigram);
+        if (posting == m_postings.end()) {
+            continue;
+        }
+        std::vector<int>& ids = posting->second;
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        if (it != ids.end() && *it == id) {
+            ids.erase(it);
+        }
+        if (ids.empty()) {
+            m_postings.erase(posting);
+        }
+    }
+}
+
+SearchIndex::KeyRef SearchIndex::store(const std::string& key) {
+    KeyRef ref{quint32(m_arena.size()), quint32(key.size())};
+    m_arena += key;
+    return ref;
+}
+
+void SearchIndex::release(const KeyRef& ref) {
+    m_garbage += ref.length;
+    // Когда мусора больше половины буфера, переупаковываем живые ключи
+    if (m_garbage < 64 * 1024 || m_garbage * 2 < m_arena.size()) {
+        return;
+    }
+    std::string arena;
+    arena.reserve(m_arena.size() - m_garbage);
+    for (auto& entry : m_keys) {
+        std::string_view key = keyView(entry.second);
+        entry.second.offset = quint32(arena.size());
+        arena.append(key.data(), key.size());
+    }
+    m_arena.swap(arena);
+    m_garbage = 0;
+}
+
+void SearchIndex::insert(int id, const std::string& key) {
+    auto existing = m_keys.find(id);
+    if (existing != m_keys.end()) {
+        if (keyView(existing->second) == key) {
+            return;
+        }
+        removePostings(id, keyView(existing->second));
+        KeyRef old = existing->second;
+        existing->second = store(key);
+        release(old);
+    } else {
+        m_keys.emplace(id, store(key));
+    }
+    addPostings(id, key);
+}
+
+void SearchIndex::remove(int id) {
+    auto existing = m_keys.find(id);
+    if (existing == m_keys.end()) {
+        return;
+    }
+    removePostings(id, keyView(existing->second));
+    KeyRef old = existing->second;
+    m_keys.erase(existing);
+    release(old);
+}
+
+void SearchIndex::clear() {
+    m_arena.clear();
+    m_garbage = 0;
+    m_keys.clear();
+    m_postings.clear();
+}
+
+std::vector<int> SearchIndex::find(const std::string& foldedQuery) const {
+    std::vector<int> result;
+
+    std::vector<Trigram> queryTrigrams = trigrams(foldedQuery);
+    if (queryTrigrams.empty()) {
+        // Запрос короче триграммы: проверяем ключи подряд, без перевода регистра
+        for (const auto& entry : m_keys) {
+            if (keyView(entry.second).find(foldedQuery) != std::string_view::npos) {
+                result.push_back(entry.first);
+            }
+        }
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+    // Пересекаем списки начиная с самого короткого
+    std::vector<const std::vector<int>*> postings;
+    postings.reserve(queryTrigrams.size());
+    for (Trigram trigram : queryTrigrams) {
+        auto posting = m_postings.find(trigram);
+        if (posting == m_postings.end()) {
+            return result;
+        }
+        postings.push_back(&posting->second);
+    }
+    std::sort(postings.begin(), postings.end(),
+        [](const std::vector<int>* a, const std::vector<int>* b) { return a->size() < b->size(); });
+
+    result = *postings.front();
+    std::vector<int> next;
+    for (size_t i = 1; i < postings.size() && !result.empty(); ++i) {
+        next.clear();
+        std::set_intersection(result.begin(), result.end(),
+                              postings[i]->begin(), postings[i]->end(),
+                              std::back_inserter(next));
+        result.swap(next);
+    }
+
+    // Все триграммы есть в ключе, но не обязательно подряд - проверяем подстроку
+    result.erase(std::remove_if(result.begin(), result.end(),
+        [this, &foldedQuery](int id) { return !matches(id, foldedQuery); }),
+        result.end());
+    return result;
+}
+
+bool SearchIndex::matches(int id, const std::string& foldedQuery) const {
+    auto key = m_keys.find(id);
+    return key != m_keys.end() && keyView(key->second).find(foldedQuery) != std::string_view::npos;
+}
+
+size_t SearchIndex::memoryUsage() const {
+    // Узлы хэш-таблиц считаем как значение плюс два указателя
+    size_t bytes = m_arena.capacity();
+    bytes += m_keys.size() * (sizeof(std::pair<const int, KeyRef>) + 2 * sizeof(void*));
+    for (const auto& entry : m_postings) {
+        bytes += sizeof(entry) + 2 * sizeof(void*) + entry.second.capacity() * sizeof(int);
+    }
+    bytes += (m_keys.bucket_count() + m_postings.bucket_count()) * sizeof(void*);
+    return bytes;
+}
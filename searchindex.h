@@ -0,0 +1,64 @@
+#pragma once
+#include <QString>
+#include <QtGlobal>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "contact.h"
+
+// Триграммный индекс для поиска подстроки по контактам.
+// Для каждого контакта хранится ключ поиска - поля, приведенные через fold (UTF-8),
+// разделенные '\n': фамилия, имя, отчество, email, адрес и цифры телефонов.
+// Ключи вычисляются один раз при добавлении и лежат подряд в одном буфере,
+// так что проверка кандидата - это сравнение байтов без выделения памяти.
+// Для каждой триграммы байтов ключа хранится отсортированный список id.
+// Запрос пересекает списки своих триграмм, кандидаты проверяются по ключу.
+// Совпадение подстроки в UTF-8 равносильно совпадению байтов, поэтому
+// триграммы берутся по байтам, а не по символам.
+class SearchIndex {
+public:
+    static std::string searchKey(const Contact& contact);
+    static std::string searchKey(std::string_view lastName, std::string_view firstName,
+                                 std::string_view middleName, std::string_view email,
+                                 std::string_view address, const std::vector<std::string_view>& phones);
+    // Вид строки для поиска: нижний регистр, ё -> е, пробельные символы
+    // сворачиваются в один пробел, по краям убираются
+    static std::string fold(const QString& text);
+
+    // Добавляет контакт или заменяет ключ уже проиндексированного
+    void insert(int id, const std::string& key);
+    void remove(int id);
+    void clear();
+    bool isEmpty() const { return m_keys.empty(); }
+
+    // id контактов, ключ которых содержит query, по возрастанию.
+    // query уже приведен через fold
+    std::vector<int> find(const std::string& foldedQuery) const;
+    bool matches(int id, const std::string& foldedQuery) const;
+
+    // Приблизительный объем памяти индекса в байтах
+    size_t memoryUsage() const;
+
+private:
+    using Trigram = quint32;
+
+    struct KeyRef {
+        quint32 offset;
+        quint32 length;
+    };
+
+    std::string m_arena;                        // ключи всех контактов подряд
+    size_t m_garbage = 0;                       // байты замененных и удаленных ключей
+    std::unordered_map<int, KeyRef> m_keys;
+    std::unordered_map<Trigram, std::vector<int>> m_postings;
+
+    std::string_view keyView(const KeyRef& ref) const {
+        return std::string_view(m_arena).substr(ref.offset, ref.length);
+    }
+    static std::vector<Trigram> trigrams(std::string_view text);
+    void addPostings(int id, std::string_view key);
+    void removePostings(int id, std::string_view key);
+    KeyRef store(const std::string& key);
+    void release(const KeyRef& ref);
+};
@@ -0,0 +1,184 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Вектор с местом под N элементов внутри самого объекта.
+// Пока элементов не больше N, память не выделяется; дальше элементы
+// переезжают в буфер из аллокатора. Элементы конструируются через
+// allocator_traits, поэтому с std::pmr::polymorphic_allocator строки
+// внутри элементов попадают в тот же ресурс, что и сам вектор.
+// Аллокатор ведет себя как у pmr-контейнеров: при присваивании не
+// переходит к приемнику, копия без явного аллокатора берет
+// select_on_container_copy_construction.
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>>
+class SmallVector {
+    using Traits = std::allocator_traits<Alloc>;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+    using size_type = std::size_t;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SmallVector() : SmallVector(Alloc()) {}
+    explicit SmallVector(const Alloc& alloc) : m_alloc(alloc) {}
+
+    SmallVector(const SmallVector& other)
+        : SmallVector(other, Traits::select_on_container_copy_construction(other.m_alloc)) {}
+
+    SmallVector(const SmallVector& other, const Alloc& alloc) : m_alloc(alloc) {
+        assign(other.begin(), other.end());
+    }
+
+    // Аллокатор переезжает вместе с элементами, поэтому кучный буфер
+    // забирается целиком, а встроенные элементы просто перемещаются
+    SmallVector(SmallVector&& other) noexcept : m_alloc(std::move(other.m_alloc)) {
+        takeFrom(other);
+    }
+
+    SmallVector(SmallVector&& other, const Alloc& alloc) : m_alloc(alloc) {
+        if (m_alloc == other.m_alloc) {
+            takeFrom(other);
+        } else {
+            moveElementsFrom(other);
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) {
+        if (this != &other) {
+            clear();
+            if (m_alloc == other.m_alloc) {
+                releaseHeap();
+                takeFrom(other);
+            } else {
+                moveElementsFrom(other);
+            }
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        clear();
+        releaseHeap();
+    }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+        clear();
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (m_size == m_capacity) {
+            grow(m_capacity * 2);
+        }
+        Traits::construct(m_alloc, m_data + m_size, std::forward<Args>(args)...);
+        return m_data[m_size++];
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void reserve(size_type capacity) {
+        if (capacity > m_capacity) {
+            grow(capacity);
+        }
+    }
+
+    void clear() {
+        for (size_type i = 0; i < m_size; ++i) {
+            Traits::destroy(m_alloc, m_data + i);
+        }
+        m_size = 0;
+    }
+
+    iterator begin() { return m_data; }
+    iterator end() { return m_data + m_size; }
+    const_iterator begin() const { return m_data; }
+    const_iterator end() const { return m_data + m_size; }
+
+    T& operator[](size_type i) { return m_data[i]; }
+    const T& operator[](size_type i) const { return m_data[i]; }
+    T* data() { return m_data; }
+    const T* data() const { return m_data; }
+
+    size_type size() const { return m_size; }
+    size_type capacity() const { return m_capacity; }
+    bool empty() const { return m_size == 0; }
+    bool isInline() const { return m_data == inlineData(); }
+
+    allocator_type get_allocator() const { return m_alloc; }
+
+private:
+    Alloc m_alloc;
+    T* m_data = inlineData();
+    size_type m_size = 0;
+    size_type m_capacity = N;
+    alignas(T) unsigned char m_inline[N * sizeof(T)];
+
+    T* inlineData() { return reinterpret_cast<T*>(m_inline); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(m_inline); }
+
+    // Новый буфер из того же аллокатора: элементы переносим обычным
+    // перемещением, их ресурс при этом не меняется
+    void grow(size_type capacity) {
+        capacity = std::max<size_type>(capacity, N + 1);
+        T* data = Traits::allocate(m_alloc, capacity);
+        for (size_type i = 0; i < m_size; ++i) {
+            ::new (static_cast<void*>(data + i)) T(std::move(m_data[i]));
+            Traits::destroy(m_alloc, m_data + i);
+        }
+        releaseHeap();
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    void releaseHeap() {
+        if (!isInline()) {
+            Traits::deallocate(m_alloc, m_data, m_capacity);
+            m_data = inlineData();
+            m_capacity = N;
+        }
+    }
+
+    // Аллокаторы равны, this пуст и без кучного буфера
+    void takeFrom(SmallVector& other) noexcept {
+        if (other.isInline()) {
+            for (size_type i = 0; i < other.m_size; ++i) {
+                ::new (static_cast<void*>(inlineData() + i)) T(std::move(other.m_data[i]));
+            }
+            m_size = other.m_size;
+            other.clear();
+        } else {
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_capacity = other.m_capacity;
+            other.m_data = other.inlineData();
+            other.m_size = 0;
+            other.m_capacity = N;
+        }
+    }
+
+    // Аллокаторы разные: элементы заново конструируются в своем ресурсе
+    void moveElementsFrom(SmallVector& other) {
+        reserve(other.m_size);
+        for (auto& value : other) {
+            emplace_back(std::move(value));
+        }
+        other.clear();
+    }
+};
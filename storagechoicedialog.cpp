@@ -11,12 +11,14 @@ StorageChoiceDialog::StorageChoiceDialog(QWidget* parent)
     
     dbRadio = new QRadioButton("База данных SQLite", this);
     fileRadio = new QRadioButton("Файл JSON", this);
+    binaryRadio = new QRadioButton("Двоичный файл", this);
     dbRadio->setChecked(true);  // По умолчанию выбрана БД
     
     auto okButton = new QPushButton("OK", this);
     
     layout->addWidget(dbRadio);
     layout->addWidget(fileRadio);
+    layout->addWidget(binaryRadio);
     layout->addWidget(okButton);
     
     connect(okButton, &QPushButton::clicked, this, &QDialog::accept);
@@ -24,4 +26,11 @@ StorageChoiceDialog::StorageChoiceDialog(QWidget* parent)
 
 bool StorageChoiceDialog::useDatabase() const {
     return dbRadio->isChecked();
+}
+
+StorageChoiceDialog::StorageType StorageChoiceDialog::storageType() const {
+    if (binaryRadio->isChecked()) {
+        return BinaryFile;
+    }
+    return fileRadio->isChecked() ? JsonFile : Database;
 }
\ No newline at end of file
@@ -7,10 +7,18 @@
 class StorageChoiceDialog : public QDialog {
     Q_OBJECT
 public:
+    enum StorageType {
+        Database,
+        JsonFile,
+        BinaryFile
+    };
+
     explicit StorageChoiceDialog(QWidget* parent = nullptr);
     bool useDatabase() const;
+    StorageType storageType() const;
     
 private:
     QRadioButton* dbRadio;
     QRadioButton* fileRadio;
+    QRadioButton* binaryRadio;
 }; 
\ No newline at end of file
@@ -0,0 +1,6 @@
+TEMPLATE = subdirs
+SUBDIRS = \
+    validation \
+    phonekernel \
+    contactimporter \
+    databasemanager
@@ -0,0 +1,29 @@
+include(../../tests.pri)
+
+QT += concurrent
+
+TARGET = tst_contactimporter
+
+SOURCES += \
+    tst_contactimporter.cpp \
+    $$PHONEBOOK_DIR/contact.cpp \
+    $$PHONEBOOK_DIR/contactimporter.cpp \
+    $$PHONEBOOK_DIR/filestorage.cpp \
+    $$PHONEBOOK_DIR/phonebook.cpp \
+    $$PHONEBOOK_DIR/phonekernel.cpp \
+    $$PHONEBOOK_DIR/phonenumber.cpp \
+    $$PHONEBOOK_DIR/prefixindex.cpp \
+    $$PHONEBOOK_DIR/searchindex.cpp \
+    $$PHONEBOOK_DIR/validation.cpp
+
+HEADERS += \
+    $$PHONEBOOK_DIR/contact.h \
+    $$PHONEBOOK_DIR/contactimporter.h \
+    $$PHONEBOOK_DIR/filestorage.h \
+    $$PHONEBOOK_DIR/istorage.h \
+    $$PHONEBOOK_DIR/phonebook.h \
+    $$PHONEBOOK_DIR/phonekernel.h \
+    $$PHONEBOOK_DIR/phonenumber.h \
+    $$PHONEBOOK_DIR/prefixindex.h \
+    $$PHONEBOOK_DIR/searchindex.h \
+    $$PHONEBOOK_DIR/validation.h
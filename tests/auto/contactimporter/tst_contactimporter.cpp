@@ -0,0 +1,325 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <memory>
+#include "contactimporter.h"
+#include "filestorage.h"
+#include "phonebook.h"
+
+// Импорт в книгу на FileStorage во временном каталоге. Сигналы импортера
+// приходят из фонового потока и собираются через очередь в потоке теста.
+
+namespace {
+
+constexpr int kChunkSize = 1 << 20; // ContactImporter::kChunkSize
+constexpr int kTimeoutMs = 60000;
+
+const char* const kCsvHeader = "Фамилия,Имя,Отчество,Дата рождения,Email,Адрес,Телефон\n";
+
+struct ImportResult {
+    bool finished = false;
+    qint64 imported = 0;
+    qint64 failed = 0;
+    QString error;
+    QList<QPair<qint64, QString>> failures;
+    qint64 processed = 0;
+    qint64 total = 0;
+};
+
+// Строка CSV с корректными полями; номер записи - в email и телефоне
+QByteArray csvRow(int record, const QByteArray& address = "Москва")
+{
+    return "Иванов,Иван,Петрович,1980-01-15,user" + QByteArray::number(record) + "@mail.ru," +
+           address + ",+7812" + QByteArray::number(record).rightJustified(7, '0') + "\n";
+}
+
+// Многострочный адрес с запятыми и кавычками; в CSV кавычки удваиваются
+QByteArray multilineAddress(int lines)
+{
+    QByteArray address;
+    for (int i = 0; i < lines; ++i) {
+        address += "Строка " + QByteArray::number(i) + ", дом \"" + QByteArray::number(i % 50) + "\"\n";
+    }
+    address += "конец";
+    return address;
+}
+
+QByteArray quoted(QByteArray field)
+{
+    return "\"" + field.replace("\"", "\"\"") + "\"";
+}
+
+QByteArray toBytes(std::string_view text)
+{
+    return QByteArray(text.data(), int(text.size()));
+}
+
+} // namespace
+
+class TestContactImporter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void csvQuotedFieldsAcrossChunks();
+    void vcardFolding();
+    void errorRecords();
+    void unterminatedVCard();
+    void cancel();
+
+private:
+    QTemporaryDir m_dir;
+    int m_bookCounter = 0;
+    std::unique_ptr<PhoneBook> m_book;
+
+    QString writeFile(const QString& name, const QByteArray& data);
+    void connectImporter(ContactImporter& importer, ImportResult& result);
+    void runImport(const QString& path, ImportResult& result);
+    bool findByEmail(const QByteArray& email, Contact& contact) const;
+};
+
+void TestContactImporter::init()
+{
+    QVERIFY(m_dir.isValid());
+    m_book = std::make_unique<PhoneBook>(
+        std::make_unique<FileStorage>(m_dir.filePath(QString("book%1.json").arg(++m_bookCounter))));
+}
+
+void TestContactImporter::cleanup()
+{
+    m_book.reset();
+}
+
+QString TestContactImporter::writeFile(const QString& name, const QByteArray& data)
+{
+    QString path = m_dir.filePath(name);
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) {
+        return QString();
+    }
+    return path;
+}
+
+// Получатель - тест: обработчики выполняются в его потоке по очереди событий
+void TestContactImporter::connectImporter(ContactImporter& importer, ImportResult& result)
+{
+    connect(&importer, &ContactImporter::progress, this, [&result](qint64 processed, qint64 total) {
+        QVERIFY(processed >= result.processed);
+        result.processed = processed;
+        result.total = total;
+    });
+    connect(&importer, &ContactImporter::recordFailed, this, [&result](qint64 record, const QString& reason) {
+        result.failures.append(qMakePair(record, reason));
+    });
+    connect(&importer, &ContactImporter::finished, this,
+            [&result](qint64 imported, qint64 failed, const QString& error) {
+        result.finished = true;
+        result.imported = imported;
+        result.failed = failed;
+        result.error = error;
+    });
+}
+
+void TestContactImporter::runImport(const QString& path, ImportResult& result)
+{
+    QVERIFY(!path.isEmpty());
+    ContactImporter importer(m_book.get());
+    connectImporter(importer, result);
+    QVERIFY2(importer.start(path), qPrintable(importer.getLastError()));
+    QTRY_VERIFY_WITH_TIMEOUT(result.finished, kTimeoutMs);
+    QVERIFY(!importer.isRunning());
+}
+
+bool TestContactImporter::findByEmail(const QByteArray& email, Contact& contact) const
+{
+    for (const Contact& candidate : m_book->getContacts()) {
+        if (toBytes(candidate.getEmail()) == email) {
+            contact = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Поле в кавычках с переводами строк пересекает границу блока, а второе
+// такое поле длиннее целого блока: запись не должна разрываться
+void TestContactImporter::csvQuotedFieldsAcrossChunks()
+{
+    QByteArray csv = kCsvHeader;
+    int records = 0;
+    while (csv.size() < kChunkSize - 200) {
+        csv += csvRow(records++);
+    }
+
+    const QByteArray shortAddress = multilineAddress(40);
+    const int shortRecord = records;
+    const int rowStart = csv.size();
+    csv += csvRow(records++, quoted(shortAddress));
+    QVERIFY(rowStart < kChunkSize && csv.size() > kChunkSize);
+
+    while (csv.size() < kChunkSize * 3 / 2) {
+        csv += csvRow(records++);
+    }
+    const QByteArray longAddress = multilineAddress(kChunkSize / 20);
+    QVERIFY(longAddress.size() > kChunkSize);
+    const int longRecord = records;
+    csv += csvRow(records++, quoted(longAddress));
+
+    for (int i = 0; i < 100; ++i) {
+        csv += csvRow(records++);
+    }
+
+    ImportResult result;
+    runImport(writeFile("chunks.csv", csv), result);
+    QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+    QCOMPARE(result.failed, qint64(0));
+    QCOMPARE(result.imported, qint64(records));
+    QCOMPARE(result.total, qint64(csv.size()));
+    QCOMPARE(result.processed, result.total);
+
+    Contact contact;
+    QVERIFY(findByEmail("user" + QByteArray::number(shortRecord) + "@mail.ru", contact));
+    QCOMPARE(toBytes(contact.getAddress()), shortAddress);
+    QVERIFY(findByEmail("user" + QByteArray::number(longRecord) + "@mail.ru", contact));
+    QCOMPARE(toBytes(contact.getAddress()), longAddress);
+    // Поля после многострочного адреса не сдвинуты
+    QCOMPARE(contact.getPhoneNumbers().size(), size_t(1));
+    QCOMPARE(toBytes(contact.getPhoneNumbers()[0].getNumber()),
+             "+7812" + QByteArray::number(longRecord).rightJustified(7, '0'));
+}
+
+// Свернутые строки (RFC 6350, 3.2): продолжение начинается с пробела или
+// табуляции, которые при разворачивании удаляются
+void TestContactImporter::vcardFolding()
+{
+    const QByteArray vcf =
+        "BEGIN:VCARD\r\n"
+        "VERSION:3.0\r\n"
+        "N:Петров;Пет\r\n"
+        " р;Сергеевич;;\r\n"
+        "FN:Петр Петров\r\n"
+        "TEL;TYPE=CELL:+7 812\r\n"
+        "  123-45-67\r\n"
+        "EMAIL:petr\r\n"
+        "\t@mail.ru\r\n"
+        "ADR;TYPE=HOME:;;Невский пр.\\, д. 1;Санкт-Петер\r\n"
+        " бург;;;Россия\r\n"
+        "BDAY:19800115\r\n"
+        "END:VCARD\r\n"
+        "BEGIN:VCARD\n"
+        "VERSION:4.0\n"
+        "N:Smith;John;;;\n"
+        "item1.TEL;VALUE=uri;TYPE=work:tel:+78127\n"
+        " 654321\n"
+        "END:VCARD\n";
+
+    ImportResult result;
+    runImport(writeFile("folded.vcf", vcf), result);
+    QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+    QCOMPARE(result.failed, qint64(0));
+    QCOMPARE(result.imported, qint64(2));
+
+    Contact contact;
+    QVERIFY(findByEmail("petr@mail.ru", contact));
+    QCOMPARE(toBytes(contact.getLastName()), QByteArray("Петров"));
+    QCOMPARE(toBytes(contact.getFirstName()), QByteArray("Петр"));
+    QCOMPARE(toBytes(contact.getMiddleName()), QByteArray("Сергеевич"));
+    QCOMPARE(toBytes(contact.getBirthDate()), QByteArray("1980-01-15"));
+    QCOMPARE(toBytes(contact.getAddress()), QByteArray("Невский пр., д. 1, Санкт-Петербург, Россия"));
+    QCOMPARE(contact.getPhoneNumbers().size(), size_t(1));
+    // У продолжения "  123-45-67" удаляется только первый пробел
+    QCOMPARE(toBytes(contact.getPhoneNumbers()[0].getNumber()), QByteArray("+78121234567"));
+    QCOMPARE(toBytes(contact.getPhoneNumbers()[0].getType()), QByteArray("Мобильный"));
+
+    QVERIFY(findByEmail("", contact));
+    QCOMPARE(toBytes(contact.getLastName()), QByteArray("Smith"));
+    QCOMPARE(contact.getPhoneNumbers().size(), size_t(1));
+    QCOMPARE(toBytes(contact.getPhoneNumbers()[0].getNumber()), QByteArray("+78127654321"));
+    QCOMPARE(toBytes(contact.getPhoneNumbers()[0].getType()), QByteArray("Рабочий"));
+}
+
+// Записи с ошибками пропускаются; номера записей считаются с 1, пустая
+// строка записью не считается, причина - первое неверное поле
+void TestContactImporter::errorRecords()
+{
+    const QByteArray csv =
+        "Иванов,Иван,Иванович,1980-01-15,ivan@mail.ru,Москва,+7 (812) 123-45-67\n"
+        "петров,Петр,,,,,\n"
+        "Сидоров,Сидор,,,sidor@mail.ru,,88121234567\n"
+        "Смирнов,Олег,,,not-an-email,,\n"
+        "Кузнецов,Антон,,,,,\"+7 812 765-43-21, 12345\"\n"
+        "\n"
+        "Попов,Павел,,15/01/1990,,,\n"
+        "Волков,Олег,,,,,\n";
+
+    ImportResult result;
+    runImport(writeFile("errors.csv", csv), result);
+    QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+    QCOMPARE(result.imported, qint64(3));
+    QCOMPARE(result.failed, qint64(4));
+
+    const QList<QPair<qint64, QString>> expected = {
+        {2, "Некорректная фамилия"},
+        {4, "Некорректный email"},
+        {5, "Некорректный номер телефона: 12345"},
+        {6, "Некорректная дата рождения"}
+    };
+    QCOMPARE(result.failures, expected);
+    QCOMPARE(int(m_book->getContacts().size()), 3);
+}
+
+void TestContactImporter::unterminatedVCard()
+{
+    const QByteArray vcf =
+        "BEGIN:VCARD\n"
+        "N:Петров;Петр;;;\n"
+        "END:VCARD\n"
+        "BEGIN:VCARD\n"
+        "N:Сидоров;Сидор;;;\n";
+
+    ImportResult result;
+    runImport(writeFile("unterminated.vcf", vcf), result);
+    QVERIFY2(result.error.isEmpty(), qPrintable(result.error));
+    QCOMPARE(result.imported, qint64(1));
+    QCOMPARE(result.failed, qint64(1));
+    QCOMPARE(result.failures.size(), 1);
+    QCOMPARE(result.failures[0].first, qint64(2));
+    QCOMPARE(result.failures[0].second, QString("Запись vCard не завершена (нет END:VCARD)"));
+}
+
+// Отмена останавливает чтение; уже добавленные контакты остаются в книге
+void TestContactImporter::cancel()
+{
+    QByteArray csv = kCsvHeader;
+    int records = 0;
+    while (csv.size() < 16 * kChunkSize) {
+        csv += csvRow(records++);
+    }
+    const QString path = writeFile("large.csv", csv);
+    QVERIFY(!path.isEmpty());
+
+    ImportResult result;
+    ContactImporter importer(m_book.get());
+    connectImporter(importer, result);
+    QVERIFY2(importer.start(path), qPrintable(importer.getLastError()));
+    QVERIFY(!importer.start(path));
+    QCOMPARE(importer.getLastError(), QString("Импорт уже выполняется"));
+    importer.cancel();
+
+    QTRY_VERIFY_WITH_TIMEOUT(result.finished, kTimeoutMs);
+    QCOMPARE(result.error, QString("Импорт отменен"));
+    QVERIFY(result.imported < records);
+    QCOMPARE(result.failed, qint64(0));
+    QCOMPARE(qint64(m_book->getContacts().size()), result.imported);
+
+    // После отмены импорт запускается заново
+    ImportResult second;
+    runImport(writeFile("small.csv", QByteArray(kCsvHeader) + csvRow(records)), second);
+    QVERIFY2(second.error.isEmpty(), qPrintable(second.error));
+    QCOMPARE(second.imported, qint64(1));
+}
+
+QTEST_GUILESS_MAIN(TestContactImporter)
+
+#include "tst_contactimporter.moc"
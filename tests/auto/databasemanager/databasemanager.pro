@@ -0,0 +1,23 @@
+include(../../tests.pri)
+
+QT += sql
+
+TARGET = tst_databasemanager
+
+SOURCES += \
+    tst_databasemanager.cpp \
+    $$PHONEBOOK_DIR/contact.cpp \
+    $$PHONEBOOK_DIR/databasemanager.cpp \
+    $$PHONEBOOK_DIR/phonenumber.cpp \
+    $$PHONEBOOK_DIR/searchindex.cpp \
+    $$PHONEBOOK_DIR/validation.cpp
+
+HEADERS += \
+    $$PHONEBOOK_DIR/contact.h \
+    $$PHONEBOOK_DIR/databasemanager.h \
+    $$PHONEBOOK_DIR/instrumentation.h \
+    $$PHONEBOOK_DIR/istorage.h \
+    $$PHONEBOOK_DIR/phonenumber.h \
+    $$PHONEBOOK_DIR/searchindex.h \
+    $$PHONEBOOK_DIR/smallvector.h \
+    $$PHONEBOOK_DIR/validation.h
@@ -0,0 +1,124 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <memory>
+#include "databasemanager.h"
+
+// Поиск в базе SQLite во временном каталоге. Запрос из цифр ищется и как
+// текст (имена, email, адрес), и как часть номера - так же, как подстрока
+// в SearchIndex у файловых хранилищ. matchesQuery и narrows должны
+// давать тот же результат, что и новый запрос к базе.
+
+namespace {
+
+Contact makeContact(std::string_view lastName, std::string_view email, std::string_view phone)
+{
+    Contact contact = Contact::fromStorage(-1, lastName, "Иван", "Петрович", "1980-01-15",
+                                           "Москва", email);
+    contact.addStoredPhoneNumber(phone, "mobile");
+    return contact;
+}
+
+QStringList lastNames(const std::vector<Contact>& contacts)
+{
+    QStringList names;
+    for (const auto& contact : contacts) {
+        names << toQString(contact.getLastName());
+    }
+    names.sort();
+    return names;
+}
+
+} // namespace
+
+class TestDatabaseManager : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void search_data();
+    void search();
+    void narrowing_data();
+    void narrowing();
+
+private:
+    QTemporaryDir m_dir;
+    std::unique_ptr<DatabaseManager> m_database;
+};
+
+void TestDatabaseManager::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_database = std::make_unique<DatabaseManager>(m_dir.filePath("test.db"));
+    QVERIFY2(m_database->isOpen(), qPrintable(m_database->getLastError()));
+    QVERIFY(m_database->addContact(makeContact("Иванов", "ivanov@mail.ru", "+7 (812) 123-45-67")));
+    QVERIFY(m_database->addContact(makeContact("Петров", "4567@mail.ru", "8 (921) 765-43-21")));
+    QVERIFY(m_database->addContact(makeContact("Сидоров", "sidorov@mail.ru", "+7 (495) 111-22-33")));
+}
+
+void TestDatabaseManager::cleanupTestCase()
+{
+    m_database.reset();
+}
+
+void TestDatabaseManager::search_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::addColumn<QStringList>("expected");
+
+    QTest::newRow("фамилия") << "Петров" << QStringList{"Петров"};
+    QTest::newRow("номер как записан") << "123-45-67" << QStringList{"Иванов"};
+    QTest::newRow("середина номера") << "4567" << QStringList{"Иванов", "Петров"};
+    QTest::newRow("середина с пробелом") << "765 43" << QStringList{"Петров"};
+    QTest::newRow("код города") << "812" << QStringList{"Иванов"};
+    QTest::newRow("начало номера") << "+7812123" << QStringList{"Иванов"};
+    QTest::newRow("нет совпадений") << "999" << QStringList{};
+}
+
+void TestDatabaseManager::search()
+{
+    QFETCH(QString, pattern);
+    QFETCH(QStringList, expected);
+
+    QCOMPARE(lastNames(m_database->findContacts(pattern)), expected);
+    for (const auto& contact : m_database->getAllContacts()) {
+        QCOMPARE(m_database->matchesQuery(contact, pattern),
+                 expected.contains(toQString(contact.getLastName())));
+    }
+}
+
+void TestDatabaseManager::narrowing_data()
+{
+    QTest::addColumn<QString>("previous");
+    QTest::addColumn<QString>("pattern");
+
+    QTest::newRow("фамилия") << "Пет" << "Петров";
+    QTest::newRow("цифры номера") << "123" << "123-45";
+    QTest::newRow("слово после номера") << "765" << "765 43";
+    // "45" - еще не номер: цифры номера ищутся только в новом запросе
+    QTest::newRow("начало номера") << "45" << "4567";
+}
+
+// Сужение - это фильтр прежнего результата через matchesQuery;
+// он должен совпасть с новым поиском
+void TestDatabaseManager::narrowing()
+{
+    QFETCH(QString, previous);
+    QFETCH(QString, pattern);
+
+    if (!m_database->narrows(previous, pattern)) {
+        return;
+    }
+    std::vector<Contact> narrowed;
+    for (auto& contact : m_database->findContacts(previous)) {
+        if (m_database->matchesQuery(contact, pattern)) {
+            narrowed.push_back(std::move(contact));
+        }
+    }
+    QCOMPARE(lastNames(narrowed), lastNames(m_database->findContacts(pattern)));
+}
+
+QTEST_GUILESS_MAIN(TestDatabaseManager)
+
+#include "tst_databasemanager.moc"
@@ -0,0 +1,14 @@
+include(../../tests.pri)
+
+TARGET = tst_phonekernel
+
+SOURCES += \
+    tst_phonekernel.cpp \
+    $$PHONEBOOK_DIR/phonekernel.cpp \
+    $$PHONEBOOK_DIR/phonenumber.cpp \
+    $$PHONEBOOK_DIR/validation.cpp
+
+HEADERS += \
+    $$PHONEBOOK_DIR/phonekernel.h \
+    $$PHONEBOOK_DIR/phonenumber.h \
+    $$PHONEBOOK_DIR/validation.h
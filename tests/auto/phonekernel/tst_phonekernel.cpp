@@ -0,0 +1,251 @@
+#include <QtTest>
+#include <random>
+#include <string>
+#include "phonekernel.h"
+#include "phonenumber.h"
+
+// Все реализации PhoneKernel (AVX2, SSE4.2, скалярная) сверяются с
+// PhoneNumber: номер действителен по validatePhoneNumber, а значение -
+// цифры normalizeNumber (+7XXXXXXXXXX). Реализации, которые процессор не
+// поддерживает, пропускаются.
+
+Q_DECLARE_METATYPE(PhoneKernel::Implementation)
+
+namespace {
+
+// Корректные номера, которые портятся правками
+const char* const kSamples[] = {
+    "+7(812)123-45-67", "88121234567", "+7 (812) 123 45 67", "8(812)1234567",
+    "+7812123-45-67", " +7 812-123-45-67 ", "8  \t (495)  1234567", "+7(812)-123-45-67",
+    "8 812 123-4567", "+7(812)123-45-67\r", "+7(812)１23-45-67", "8 812 123 45 67"
+};
+
+// Вставки и замены: байты векторного пути, цифры и пробелы вне ASCII
+const char32_t kMutations[] = {
+    U'0', U'1', U'2', U'5', U'7', U'8', U'9', U' ', U'+', U'(', U')', U'-', U'\t',
+    U'\r', U'\v', U'\f', U'x', U'.', U'٣', U'１', U' ', U'　', U'\U0001D7CE', U'Ж'
+};
+
+constexpr int kMutatedCount = 300000;
+
+QByteArray toUtf8(const std::u32string& text)
+{
+    return QString::fromUcs4(text.data(), int(text.size())).toUtf8();
+}
+
+// Ожидаемый результат: 0, если номер недействителен, иначе цифры
+// PhoneNumber::normalizeNumber (цифры вне ASCII - по их значению)
+quint64 expectedNumber(const QByteArray& text)
+{
+    std::string_view view(text.constData(), size_t(text.size()));
+    if (!PhoneNumber::validatePhoneNumber(view)) {
+        return 0;
+    }
+    quint64 value = 0;
+    for (QChar c : QString::fromStdString(PhoneNumber::normalizeNumber(view))) {
+        if (c != '+') {
+            value = value * 10 + quint64(c.digitValue());
+        }
+    }
+    return value;
+}
+
+} // namespace
+
+class TestPhoneKernel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void examples_data();
+    void examples();
+    void mutatedSamples_data();
+    void mutatedSamples();
+    void batch_data();
+    void batch();
+    void batchLines();
+
+private:
+    void addImplementations();
+};
+
+void TestPhoneKernel::addImplementations()
+{
+    QTest::addColumn<PhoneKernel::Implementation>("implementation");
+    QTest::newRow("scalar") << PhoneKernel::Implementation::Scalar;
+    QTest::newRow("sse4.2") << PhoneKernel::Implementation::Sse42;
+    QTest::newRow("avx2") << PhoneKernel::Implementation::Avx2;
+}
+
+void TestPhoneKernel::examples_data()
+{
+    addImplementations();
+}
+
+void TestPhoneKernel::examples()
+{
+    QFETCH(PhoneKernel::Implementation, implementation);
+    if (!PhoneKernel::isSupported(implementation)) {
+        QSKIP("Процессор не поддерживает эту реализацию");
+    }
+
+    const struct {
+        const char* text;
+        quint64 e164;
+    } cases[] = {
+        {"+78121234567", 78121234567ULL},
+        {"88121234567", 78121234567ULL},
+        {"8(812)123-45-67", 78121234567ULL},
+        {" +7 (495) 765 43 21 ", 74957654321ULL},
+        {"+7(812)１23-45-67", 78121234567ULL},
+        // Длиннее блока AVX2: только скалярный путь
+        {"                    +7(812)123-45-67", 78121234567ULL},
+        {"7812123456", 0},
+        {"+7(812)123-45-6", 0},
+        {"+7(812)123--45-67", 0},
+        {"+8(812)123-45-67", 0},
+        {"", 0}
+    };
+    for (const auto& c : cases) {
+        quint64 e164 = 1;
+        bool valid = PhoneKernel::normalize(c.text, e164, implementation);
+        QVERIFY2(valid == (c.e164 != 0), c.text);
+        QVERIFY2(e164 == c.e164, c.text);
+    }
+}
+
+void TestPhoneKernel::mutatedSamples_data()
+{
+    addImplementations();
+}
+
+void TestPhoneKernel::mutatedSamples()
+{
+    QFETCH(PhoneKernel::Implementation, implementation);
+    if (!PhoneKernel::isSupported(implementation)) {
+        QSKIP("Процессор не поддерживает эту реализацию");
+    }
+
+    std::mt19937 random(1);
+    auto pick = [&random](size_t size) {
+        return size_t(std::uniform_int_distribution<size_t>(0, size - 1)(random));
+    };
+    const size_t mutationsSize = sizeof(kMutations) / sizeof(kMutations[0]);
+
+    int mismatches = 0;
+    int valid = 0;
+    QString firstMismatch;
+    for (int n = 0; n < kMutatedCount; ++n) {
+        std::u32string text;
+        if (pick(10) == 0) {
+            // Случайная строка до 34 символов: по обе стороны границы блока
+            size_t length = pick(35);
+            for (size_t i = 0; i < length; ++i) {
+                text += kMutations[pick(mutationsSize)];
+            }
+        } else {
+            // До трех вставок, удалений или замен в случайном образце
+            text = QString::fromUtf8(kSamples[pick(sizeof(kSamples) / sizeof(kSamples[0]))])
+                       .toStdU32String();
+            int edits = int(pick(4));
+            for (int e = 0; e < edits; ++e) {
+                size_t pos = pick(text.size() + 1);
+                size_t last = text.empty() ? 0 : std::min(pos, text.size() - 1);
+                switch (pick(3)) {
+                case 0:
+                    text.insert(text.begin() + std::ptrdiff_t(pos), kMutations[pick(mutationsSize)]);
+                    break;
+                case 1:
+                    if (!text.empty()) {
+                        text.erase(last, 1);
+                    }
+                    break;
+                default:
+                    if (!text.empty()) {
+                        text[last] = kMutations[pick(mutationsSize)];
+                    }
+                    break;
+                }
+            }
+            if (pick(20) == 0) {
+                text.insert(0, pick(20), U' ');
+            }
+        }
+
+        QByteArray utf8 = toUtf8(text);
+        quint64 expected = expectedNumber(utf8);
+        quint64 e164 = 1;
+        bool ok = PhoneKernel::normalize(std::string_view(utf8.constData(), size_t(utf8.size())),
+                                         e164, implementation);
+        valid += ok;
+        if (ok != (expected != 0) || e164 != expected) {
+            if (mismatches++ == 0) {
+                firstMismatch = QString("\"%1\" (%2): ожидалось %3, получено %4")
+                    .arg(QString::fromUtf8(utf8), QString(utf8.toHex()))
+                    .arg(expected).arg(e164);
+            }
+        }
+    }
+
+    // Правки должны оставлять заметную долю действительных номеров
+    QVERIFY(valid > kMutatedCount / 10);
+    QVERIFY2(mismatches == 0, qPrintable(QString("%1 расхождений из %2, первое: %3")
+                                         .arg(mismatches).arg(kMutatedCount).arg(firstMismatch)));
+}
+
+void TestPhoneKernel::batch_data()
+{
+    addImplementations();
+}
+
+// Пакет дает те же номера, что и разбор по одному, в том числе на границах
+// слов маски действительности
+void TestPhoneKernel::batch()
+{
+    QFETCH(PhoneKernel::Implementation, implementation);
+    if (!PhoneKernel::isSupported(implementation)) {
+        QSKIP("Процессор не поддерживает эту реализацию");
+    }
+
+    QByteArray buffer;
+    QList<QByteArray> lines;
+    for (int i = 0; i < 200; ++i) {
+        QByteArray line = i % 3 == 0 ? QByteArray("+7(812)123-45-6") + QByteArray::number(i % 10)
+                                     : QByteArray("8 495 765 43 ") + QByteArray::number(10 + i % 90);
+        if (i % 7 == 0) {
+            line.prepend('x');
+        }
+        lines.append(line);
+        buffer += line;
+        buffer += '\n';
+    }
+    buffer.chop(1);
+
+    PhoneKernel::Result result =
+        PhoneKernel::normalize(std::string_view(buffer.constData(), size_t(buffer.size())), implementation);
+    QCOMPARE(result.size(), size_t(lines.size()));
+    QCOMPARE(result.validMask.size(), size_t((lines.size() + 63) / 64));
+    for (int i = 0; i < lines.size(); ++i) {
+        quint64 expected = expectedNumber(lines[i]);
+        QCOMPARE(result.isValid(size_t(i)), expected != 0);
+        QCOMPARE(result.numbers[size_t(i)], expected);
+    }
+}
+
+void TestPhoneKernel::batchLines()
+{
+    QCOMPARE(PhoneKernel::normalize(std::string_view()).size(), size_t(0));
+
+    // Пустая строка - недействительный номер, '\n' в конце строку не добавляет
+    PhoneKernel::Result result = PhoneKernel::normalize(std::string_view("x\n\n88121234567\n"));
+    QCOMPARE(result.size(), size_t(3));
+    QVERIFY(!result.isValid(0));
+    QVERIFY(!result.isValid(1));
+    QVERIFY(result.isValid(2));
+    QCOMPARE(result.numbers[2], 78121234567ULL);
+    QCOMPARE(QString::fromStdString(PhoneKernel::format(result.numbers[2])), QString("+78121234567"));
+}
+
+QTEST_APPLESS_MAIN(TestPhoneKernel)
+
+#include "tst_phonekernel.moc"
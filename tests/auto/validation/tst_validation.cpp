@@ -0,0 +1,268 @@
+#include <QtTest>
+#include <QRegExp>
+#include <algorithm>
+#include <random>
+#include <string>
+#include "validation.h"
+
+// Validation заменила регулярные выражения QRegExp. Тест сверяет ее с самими
+// выражениями: все короткие строки над алфавитом "трудных" символов и
+// случайные правки корректных значений должны давать тот же ответ.
+
+namespace {
+
+// Прежние выражения из Contact и PhoneNumber
+const char* const kNamePattern = "^[А-ЯA-Z][а-яА-Яa-zA-Z0-9\\s-]*[^-\\s]$";
+const char* const kEmailPattern = "^[a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\\.[a-zA-Z]{2,}$";
+const char* const kPhonePattern =
+    "^(\\+7|8)\\s*\\(?(\\d{3})\\)?[-\\s]?(\\d{3})[-\\s]?(\\d{2})[-\\s]?(\\d{2})$";
+const char* const kStrictPhonePattern =
+    "^(\\+7|8)(\\(\\d{3}\\)|\\d{3})(\\d{7}|\\d{3}-\\d{2}-\\d{2})$";
+
+// Символы, на которых расходятся ASCII, QChar и UTF-8: кириллица вместе с Ё,
+// цифры и пробелы вне ASCII, символы вне BMP, разделители номера и email.
+// U+001C - разделитель, но не пробел для QChar; U+180E - бывший пробел Юникода
+const char32_t kAlphabet[] = {
+    U'A', U'Я', U'я', U'Ё', U'ё', U'a', U'0', U'٣', U'\U0001D7CE', U'-',
+    U' ', U'\t', U' ', U'　', U'\u001C', U'᠎', U'.', U'@', U'+', U'7',
+    U'8', U'(', U')', U'%', U'\U0001F600', U'Z'
+};
+
+// Вставки и замены для случайных правок: добавлены цифры разных систем
+const char32_t kMutations[] = {
+    U'1', U'2', U'3', U'4', U'5', U'6', U'9', U'b', U'c', U'd', U'r', U'u', U'm', U'l',
+    U' ', U'٠', U'１', U'१', U'\U0001D7CF'
+};
+
+// Корректные значения, которые портятся правками
+const char* const kSamples[] = {
+    "+7(812)123-45-67", "88121234567", "+7 (812) 123 45 67", "8(812)1234567",
+    "+7812123-45-67", " +7 812-123-45-67 ", "ivan.petrov@mail.ru", "a@b.cd",
+    "x_y%z+w-1@sub-d.ex.ample.org", "Иванов", "Анна-Мария", "John Smith2",
+    "Петров-Водкин", "Ab"
+};
+
+constexpr int kMaxLength = 4;
+constexpr int kMutatedCount = 400000;
+
+QByteArray toUtf8(const std::u32string& text)
+{
+    return QString::fromUcs4(text.data(), int(text.size())).toUtf8();
+}
+
+} // namespace
+
+class TestValidation : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void examples_data();
+    void examples();
+    void emptyInput();
+    void shortStrings();
+    void mutatedSamples();
+    void invalidUtf8();
+
+private:
+    QRegExp m_name{QString::fromUtf8(kNamePattern)};
+    QRegExp m_email{kEmailPattern};
+    QRegExp m_phone{kPhonePattern};
+    QRegExp m_strictPhone{kStrictPhonePattern};
+    int m_mismatches = 0;
+    QString m_firstMismatch;
+
+    void check(const QByteArray& text);
+    void resetMismatches();
+};
+
+// Сверяет все четыре проверки на одной строке и запоминает первое расхождение
+void TestValidation::check(const QByteArray& text)
+{
+    std::string_view view(text.constData(), size_t(text.size()));
+    QString trimmed = QString::fromUtf8(text).trimmed();
+
+    // Пустой email допустим: Contact::validateEmail пропускал его до выражения
+    const bool expected[] = {
+        m_name.exactMatch(trimmed),
+        text.isEmpty() || m_email.exactMatch(trimmed),
+        m_phone.exactMatch(trimmed),
+        m_strictPhone.exactMatch(trimmed)
+    };
+    const bool actual[] = {
+        Validation::isName(view),
+        Validation::isEmail(view),
+        Validation::isPhoneNumber(view),
+        Validation::isStrictPhoneNumber(view)
+    };
+    const char* const names[] = {"isName", "isEmail", "isPhoneNumber", "isStrictPhoneNumber"};
+
+    for (int i = 0; i < 4; ++i) {
+        if (expected[i] != actual[i]) {
+            if (m_mismatches++ == 0) {
+                m_firstMismatch = QString("%1(\"%2\" / %3): ожидалось %4")
+                    .arg(names[i], QString::fromUtf8(text), QString(text.toHex()))
+                    .arg(expected[i]);
+            }
+        }
+    }
+}
+
+void TestValidation::resetMismatches()
+{
+    m_mismatches = 0;
+    m_firstMismatch.clear();
+}
+
+void TestValidation::examples_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<bool>("name");
+    QTest::addColumn<bool>("email");
+    QTest::addColumn<bool>("phone");
+    QTest::addColumn<bool>("strictPhone");
+
+    QTest::newRow("+7 слитно") << "+78121234567" << false << false << true << true;
+    QTest::newRow("8 слитно") << "88121234567" << false << false << true << true;
+    QTest::newRow("код в скобках") << "+7(812)1234567" << false << false << true << true;
+    QTest::newRow("дефисы") << "8(812)123-45-67" << false << false << true << true;
+    QTest::newRow("пробелы") << "+7 (812) 123 45 67" << false << false << true << false;
+    QTest::newRow("без префикса") << "7812123456" << false << false << false << false;
+    QTest::newRow("цифра не ASCII") << "+7(812)１23-45-67" << false << false << true << true;
+    QTest::newRow("фамилия") << "Иванов" << true << false << false << false;
+    QTest::newRow("двойное имя") << "Анна-Мария" << true << false << false << false;
+    QTest::newRow("строчная") << "иванов" << false << false << false << false;
+    QTest::newRow("Ё вне А-Я") << "Ёлкин" << false << false << false << false;
+    QTest::newRow("дефис в конце") << "Петров-" << false << false << false << false;
+    QTest::newRow("пробелы по краям") << "  Петров  " << true << false << false << false;
+    QTest::newRow("email") << "ivan.petrov@mail.ru" << false << true << false << false;
+    QTest::newRow("короткий домен") << "a@b.c" << false << false << false << false;
+}
+
+void TestValidation::examples()
+{
+    QFETCH(QString, text);
+    QFETCH(bool, name);
+    QFETCH(bool, email);
+    QFETCH(bool, phone);
+    QFETCH(bool, strictPhone);
+
+    QByteArray utf8 = text.toUtf8();
+    std::string_view view(utf8.constData(), size_t(utf8.size()));
+    QCOMPARE(Validation::isName(view), name);
+    QCOMPARE(Validation::isEmail(view), email);
+    QCOMPARE(Validation::isPhoneNumber(view), phone);
+    QCOMPARE(Validation::isStrictPhoneNumber(view), strictPhone);
+}
+
+void TestValidation::emptyInput()
+{
+    QVERIFY(!Validation::isName(""));
+    QVERIFY(Validation::isEmail(""));
+    QVERIFY(!Validation::isPhoneNumber(""));
+    QVERIFY(!Validation::isStrictPhoneNumber(""));
+    // Одни пробелы - уже не пустая строка
+    QVERIFY(!Validation::isEmail(" \t"));
+}
+
+void TestValidation::shortStrings()
+{
+    resetMismatches();
+    const int alphabetSize = int(sizeof(kAlphabet) / sizeof(kAlphabet[0]));
+    int count = 0;
+
+    // Строка длины length - число в системе счисления alphabetSize
+    for (int length = 1; length <= kMaxLength; ++length) {
+        std::vector<int> digits(size_t(length), 0);
+        std::u32string text(size_t(length), kAlphabet[0]);
+        for (;;) {
+            check(toUtf8(text));
+            ++count;
+
+            int pos = length - 1;
+            while (pos >= 0 && ++digits[size_t(pos)] == alphabetSize) {
+                digits[size_t(pos)] = 0;
+                text[size_t(pos)] = kAlphabet[0];
+                --pos;
+            }
+            if (pos < 0) {
+                break;
+            }
+            text[size_t(pos)] = kAlphabet[digits[size_t(pos)]];
+        }
+    }
+
+    QVERIFY2(m_mismatches == 0, qPrintable(QString("%1 расхождений из %2, первое: %3")
+                                           .arg(m_mismatches).arg(count).arg(m_firstMismatch)));
+}
+
+void TestValidation::mutatedSamples()
+{
+    resetMismatches();
+    std::mt19937 random(1);
+    auto pick = [&random](size_t size) {
+        return size_t(std::uniform_int_distribution<size_t>(0, size - 1)(random));
+    };
+
+    const size_t alphabetSize = sizeof(kAlphabet) / sizeof(kAlphabet[0]);
+    const size_t mutationsSize = sizeof(kMutations) / sizeof(kMutations[0]);
+    auto randomChar = [&]() {
+        size_t i = pick(alphabetSize + mutationsSize);
+        return i < alphabetSize ? kAlphabet[i] : kMutations[i - alphabetSize];
+    };
+
+    // До трех вставок, удалений или замен в случайном образце
+    for (int n = 0; n < kMutatedCount; ++n) {
+        const char* sample = kSamples[pick(sizeof(kSamples) / sizeof(kSamples[0]))];
+        std::u32string text = QString::fromUtf8(sample).toStdU32String();
+        int edits = int(pick(4));
+        for (int e = 0; e < edits; ++e) {
+            size_t pos = pick(text.size() + 1);
+            size_t last = text.empty() ? 0 : std::min(pos, text.size() - 1);
+            switch (pick(3)) {
+            case 0:
+                text.insert(text.begin() + std::ptrdiff_t(pos), randomChar());
+                break;
+            case 1:
+                if (!text.empty()) {
+                    text.erase(last, 1);
+                }
+                break;
+            default:
+                if (!text.empty()) {
+                    text[last] = randomChar();
+                }
+                break;
+            }
+        }
+        check(toUtf8(text));
+    }
+
+    QVERIFY2(m_mismatches == 0, qPrintable(QString("%1 расхождений из %2, первое: %3")
+                                           .arg(m_mismatches).arg(kMutatedCount).arg(m_firstMismatch)));
+}
+
+void TestValidation::invalidUtf8()
+{
+    // Некорректные байты QString::fromUtf8 заменяет на U+FFFD - Validation тоже
+    resetMismatches();
+    for (const char* sample : kSamples) {
+        QByteArray valid(sample);
+        for (int byte = 0x80; byte <= 0xFF; ++byte) {
+            for (int pos : {0, valid.size() / 2, valid.size()}) {
+                QByteArray text = valid;
+                text.insert(pos, char(byte));
+                check(text);
+            }
+        }
+        // Обрезанная многобайтовая последовательность в конце
+        QByteArray cut = QString::fromUtf8(sample).append(QChar(0x0416)).toUtf8();
+        cut.chop(1);
+        check(cut);
+    }
+    QVERIFY2(m_mismatches == 0, qPrintable(m_firstMismatch));
+}
+
+QTEST_APPLESS_MAIN(TestValidation)
+
+#include "tst_validation.moc"
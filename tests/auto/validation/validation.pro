@@ -0,0 +1,10 @@
+include(../../tests.pri)
+
+TARGET = tst_validation
+
+SOURCES += \
+    tst_validation.cpp \
+    $$PHONEBOOK_DIR/validation.cpp
+
+HEADERS += \
+    $$PHONEBOOK_DIR/validation.h
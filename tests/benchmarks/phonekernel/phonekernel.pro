@@ -0,0 +1,17 @@
+include(../../tests.pri)
+
+# make benchmark, а не make check
+CONFIG += benchmark
+
+TARGET = tst_bench_phonekernel
+
+SOURCES += \
+    tst_bench_phonekernel.cpp \
+    $$PHONEBOOK_DIR/phonekernel.cpp \
+    $$PHONEBOOK_DIR/phonenumber.cpp \
+    $$PHONEBOOK_DIR/validation.cpp
+
+HEADERS += \
+    $$PHONEBOOK_DIR/phonekernel.h \
+    $$PHONEBOOK_DIR/phonenumber.h \
+    $$PHONEBOOK_DIR/validation.h
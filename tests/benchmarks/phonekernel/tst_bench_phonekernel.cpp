@@ -0,0 +1,122 @@
+#include <QtTest>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <string>
+#include "phonekernel.h"
+#include "phonenumber.h"
+
+// Пропускная способность нормализации номеров: каждая реализация PhoneKernel
+// и прежний путь импорта (validatePhoneNumber + normalizeNumber на каждый
+// номер). Результат QBENCHMARK - время на весь буфер из kCount номеров,
+// пропускная способность (номеров в секунду) выводится отдельно.
+
+Q_DECLARE_METATYPE(PhoneKernel::Implementation)
+
+namespace {
+
+constexpr int kCount = 100000;
+
+// Форматы из реальных выгрузок, каждый десятый номер недействителен
+const char* const kNumbers[] = {
+    "+7(812)123-45-67", "88121234567", "+7 (812) 123 45 67", "8(812)1234567",
+    "+7812123-45-67", " +7 812-123-45-67 ", "8 812 123-4567", "+7(812)123-45-67\r",
+    "8 (495) 765-43-21", "+7(812)123-45-6"
+};
+
+// Номеров в секунду по суммарному времени всех прогонов QBENCHMARK
+void reportThroughput(qint64 nsecs, int runs)
+{
+    if (nsecs > 0) {
+        qDebug() << "Номеров в секунду:" << qint64(double(kCount) * runs * 1e9 / double(nsecs));
+    }
+}
+
+} // namespace
+
+class BenchPhoneKernel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void normalize_data();
+    void normalize();
+    void phoneNumber();
+
+private:
+    std::string m_buffer;
+    std::vector<std::string_view> m_lines;
+};
+
+void BenchPhoneKernel::initTestCase()
+{
+    const int samples = int(sizeof(kNumbers) / sizeof(kNumbers[0]));
+    for (int i = 0; i < kCount; ++i) {
+        m_buffer += kNumbers[i % samples];
+        m_buffer += '\n';
+    }
+    m_buffer.pop_back();
+
+    std::string_view buffer(m_buffer);
+    size_t pos = 0;
+    while (pos < buffer.size()) {
+        size_t end = std::min(buffer.find('\n', pos), buffer.size());
+        m_lines.push_back(buffer.substr(pos, end - pos));
+        pos = end + 1;
+    }
+    qDebug() << "Реализация по умолчанию:" << PhoneKernel::implementation();
+}
+
+void BenchPhoneKernel::normalize_data()
+{
+    QTest::addColumn<PhoneKernel::Implementation>("implementation");
+    QTest::newRow("scalar") << PhoneKernel::Implementation::Scalar;
+    QTest::newRow("sse4.2") << PhoneKernel::Implementation::Sse42;
+    QTest::newRow("avx2") << PhoneKernel::Implementation::Avx2;
+}
+
+void BenchPhoneKernel::normalize()
+{
+    QFETCH(PhoneKernel::Implementation, implementation);
+    if (!PhoneKernel::isSupported(implementation)) {
+        QSKIP("Процессор не поддерживает эту реализацию");
+    }
+
+    PhoneKernel::Result result;
+    QElapsedTimer timer;
+    qint64 nsecs = 0;
+    int runs = 0;
+    QBENCHMARK {
+        timer.start();
+        result = PhoneKernel::normalize(m_buffer, implementation);
+        nsecs += timer.nsecsElapsed();
+        ++runs;
+    }
+    QCOMPARE(result.size(), size_t(kCount));
+    reportThroughput(nsecs, runs);
+}
+
+void BenchPhoneKernel::phoneNumber()
+{
+    int valid = 0;
+    QElapsedTimer timer;
+    qint64 nsecs = 0;
+    int runs = 0;
+    QBENCHMARK {
+        timer.start();
+        valid = 0;
+        for (std::string_view line : m_lines) {
+            if (PhoneNumber::validatePhoneNumber(line)) {
+                valid += !PhoneNumber::normalizeNumber(line).empty();
+            }
+        }
+        nsecs += timer.nsecsElapsed();
+        ++runs;
+    }
+    QCOMPARE(valid, kCount - kCount / 10);
+    reportThroughput(nsecs, runs);
+}
+
+QTEST_APPLESS_MAIN(BenchPhoneKernel)
+
+#include "tst_bench_phonekernel.moc"
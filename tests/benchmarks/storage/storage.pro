@@ -0,0 +1,36 @@
+include(../../tests.pri)
+
+QT += sql concurrent
+
+# make benchmark, а не make check
+CONFIG += benchmark
+
+TARGET = tst_bench_storage
+
+SOURCES += \
+    tst_bench_storage.cpp \
+    $$PHONEBOOK_DIR/binarystorage.cpp \
+    $$PHONEBOOK_DIR/contact.cpp \
+    $$PHONEBOOK_DIR/contacttablemodel.cpp \
+    $$PHONEBOOK_DIR/databasemanager.cpp \
+    $$PHONEBOOK_DIR/filestorage.cpp \
+    $$PHONEBOOK_DIR/phonebook.cpp \
+    $$PHONEBOOK_DIR/phonenumber.cpp \
+    $$PHONEBOOK_DIR/prefixindex.cpp \
+    $$PHONEBOOK_DIR/searchindex.cpp \
+    $$PHONEBOOK_DIR/validation.cpp
+
+HEADERS += \
+    $$PHONEBOOK_DIR/binarystorage.h \
+    $$PHONEBOOK_DIR/contact.h \
+    $$PHONEBOOK_DIR/contacttablemodel.h \
+    $$PHONEBOOK_DIR/databasemanager.h \
+    $$PHONEBOOK_DIR/filestorage.h \
+    $$PHONEBOOK_DIR/instrumentation.h \
+    $$PHONEBOOK_DIR/istorage.h \
+    $$PHONEBOOK_DIR/phonebook.h \
+    $$PHONEBOOK_DIR/phonenumber.h \
+    $$PHONEBOOK_DIR/prefixindex.h \
+    $$PHONEBOOK_DIR/searchindex.h \
+    $$PHONEBOOK_DIR/smallvector.h \
+    $$PHONEBOOK_DIR/validation.h
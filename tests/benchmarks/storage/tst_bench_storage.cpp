@@ -0,0 +1,454 @@
+#include <QtTest>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <vector>
+#include "binarystorage.h"
+#include "contact.h"
+#include "contacttablemodel.h"
+#include "databasemanager.h"
+#include "filestorage.h"
+#include "phonebook.h"
+
+// Замеры хранилищ на книге из kContacts контактов: число запросов и время
+// поиска в базе, число выделений памяти на набор контактов, заполнение
+// таблицы контактов, загрузка книги из файла и из базы, память индекса поиска.
+// Результат QBENCHMARK - время одного вызова.
+
+namespace {
+std::atomic<long> g_allocations{0};
+}
+
+// Счетчик выделений через operator new: строки контактов и контейнеры STL.
+// QString выделяет память через malloc и здесь не учитывается
+void* operator new(std::size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+    std::free(memory);
+}
+
+namespace {
+
+constexpr int kContacts = 5000;
+// Телефоны результатов поиска загружаются пачками (kPhoneBatchSize в databasemanager.cpp)
+constexpr int kPhoneBatchSize = 256;
+
+const char* const kLastNames[] = {
+    "Иванов", "Петров", "Сидоров", "Смирнов", "Кузнецов", "Попов", "Васильев",
+    "Соколов", "Михайлов", "Новиков", "Федоров", "Морозов", "Волков", "Алексеев",
+    "Лебедев", "Семенов", "Егоров", "Павлов", "Козлов", "Степанов"
+};
+const char* const kFirstNames[] = {
+    "Александр", "Дмитрий", "Максим", "Сергей", "Андрей", "Алексей", "Артем",
+    "Илья", "Кирилл", "Михаил", "Никита", "Матвей", "Роман", "Егор"
+};
+const char* const kMiddleNames[] = {
+    "Александрович", "Дмитриевич", "Сергеевич", "Андреевич", "Иванович", "Петрович"
+};
+
+template<size_t N>
+const char* pick(const char* const (&names)[N], int i)
+{
+    return names[size_t(i) % N];
+}
+
+// Контакт i: у каждого полные ФИО, дата, адрес, email и два телефона
+Contact makeContact(int i)
+{
+    std::string email = "user" + std::to_string(i) + "@mail.ru";
+    std::string address = "Санкт-Петербург, Невский пр., д. " + std::to_string(i % 150 + 1);
+    std::string birthDate = QDate(1960, 1, 1).addDays(i % 15000).toString("yyyy-MM-dd").toStdString();
+    Contact contact = Contact::fromStorage(-1, pick(kLastNames, i), pick(kFirstNames, i / 3),
+                                           pick(kMiddleNames, i / 7), birthDate, address, email);
+
+    char mobile[16];
+    char work[16];
+    std::snprintf(mobile, sizeof(mobile), "+7921%07d", i);
+    std::snprintf(work, sizeof(work), "+7812%07d", i);
+    contact.addStoredPhoneNumber(mobile, "mobile");
+    contact.addStoredPhoneNumber(work, "work");
+    return contact;
+}
+
+std::vector<Contact> makeBook()
+{
+    std::vector<Contact> contacts;
+    contacts.reserve(kContacts);
+    for (int i = 0; i < kContacts; ++i) {
+        contacts.push_back(makeContact(i));
+    }
+    return contacts;
+}
+
+std::unique_ptr<IStorage> createStorage(const QString& format, const QString& path)
+{
+    if (format == "json") {
+        return std::make_unique<FileStorage>(path);
+    }
+    return std::make_unique<BinaryStorage>(path);
+}
+
+} // namespace
+
+class BenchStorage : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void findContacts_data();
+    void findContacts();
+    void loadPhones_data();
+    void loadPhones();
+    void contactSet_data();
+    void contactSet();
+    void tableReload();
+    void tableData();
+    void openStorage_data();
+    void openStorage();
+    void loadDatabase();
+    void buildContacts_data();
+    void buildContacts();
+
+private:
+    QTemporaryDir m_dir;
+    std::unique_ptr<DatabaseManager> m_database;
+    std::unique_ptr<PhoneBook> m_book;   // JSON: контакты уже в памяти
+};
+
+void BenchStorage::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+    m_database = std::make_unique<DatabaseManager>(m_dir.filePath("bench.db"));
+    QVERIFY2(m_database->isOpen(), qPrintable(m_database->getLastError()));
+
+    std::vector<Contact> contacts = makeBook();
+    std::vector<bool> added = m_database->addContacts(contacts);
+    QCOMPARE(int(std::count(added.begin(), added.end(), true)), kContacts);
+
+    m_book = std::make_unique<PhoneBook>(std::make_unique<FileStorage>(m_dir.filePath("book.json")));
+    added = m_book->addContacts(contacts);
+    QCOMPARE(int(std::count(added.begin(), added.end(), true)), kContacts);
+}
+
+void BenchStorage::cleanupTestCase()
+{
+    m_book.reset();
+    m_database.reset();
+}
+
+void BenchStorage::findContacts_data()
+{
+    QTest::addColumn<QString>("pattern");
+    QTest::newRow("одна фамилия") << QString("Иванов");
+    QTest::newRow("фамилия и имя") << QString("Петров Дмитрий");
+    QTest::newRow("широкий запрос") << QString("а");
+    QTest::newRow("префикс телефона") << QString("+78120001");
+    QTest::newRow("вся книга") << QString("");
+}
+
+// Число запросов считается на первом вызове: один запрос поиска и по
+// запросу телефонов на пачку. Прежний путь с запросом телефонов на каждый
+// контакт замеряется в loadPhones
+void BenchStorage::findContacts()
+{
+    QFETCH(QString, pattern);
+
+    DatabaseManager::resetReadQueryCount();
+    std::vector<Contact> results = m_database->findContacts(pattern);
+    const int queries = DatabaseManager::getReadQueryCount();
+    QVERIFY(!results.empty());
+    qDebug() << "Найдено:" << results.size() << "запросов:" << queries;
+    QVERIFY(queries <= 1 + (int(results.size()) + kPhoneBatchSize - 1) / kPhoneBatchSize);
+
+    // Результаты поиска - полные контакты, как у getAllContacts
+    const Contact& first = results.front();
+    QVERIFY(!first.getMiddleName().empty());
+    QVERIFY(!first.getBirthDate().empty());
+    QVERIFY(!first.getAddress().empty());
+    QCOMPARE(first.getPhoneNumbers().size(), size_t(2));
+
+    QBENCHMARK {
+        results = m_database->findContacts(pattern);
+    }
+}
+
+void BenchStorage::loadPhones_data()
+{
+    QTest::addColumn<bool>("batched");
+    QTest::newRow("по запросу на контакт") << false;
+    QTest::newRow("пачками") << true;
+}
+
+// Телефоны результатов широкого поиска: прежний loadPhoneNumbers (запрос на
+// каждый контакт) и запрос на пачку, как в attachPhoneNumbers. Запросы
+// выполняются на отдельном соединении с той же базой
+void BenchStorage::loadPhones()
+{
+    QFETCH(bool, batched);
+
+    std::vector<int> ids;
+    for (const auto& contact : m_database->findContacts("а")) {
+        ids.push_back(contact.getId());
+    }
+    QVERIFY(!ids.empty());
+
+    const QString connectionName = "bench_phones";
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        db.setDatabaseName(m_dir.filePath("bench.db"));
+        QVERIFY2(db.open(), qPrintable(db.lastError().text()));
+
+        const int batchSize = batched ? kPhoneBatchSize : 1;
+        QString placeholders = "?";
+        for (int i = 1; i < batchSize; ++i) {
+            placeholders += ", ?";
+        }
+        QSqlQuery query(db);
+        QVERIFY(query.prepare(batched ? "SELECT contact_id, number, type FROM phone_numbers "
+                                        "WHERE contact_id IN (" + placeholders + ") ORDER BY contact_id, id"
+                                      : "SELECT number, type FROM phone_numbers WHERE contact_id=?"));
+
+        int queries = 0;
+        int phones = 0;
+        auto load = [&]() {
+            queries = 0;
+            phones = 0;
+            for (size_t start = 0; start < ids.size(); start += size_t(batchSize)) {
+                for (int i = 0; i < batchSize; ++i) {
+                    size_t index = start + size_t(i);
+                    query.bindValue(i, index < ids.size() ? ids[index] : -1);
+                }
+                if (!query.exec()) {
+                    return false;
+                }
+                ++queries;
+                while (query.next()) {
+                    ++phones;
+                }
+            }
+            return true;
+        };
+
+        QVERIFY2(load(), qPrintable(query.lastError().text()));
+        QCOMPARE(phones, int(ids.size()) * 2);
+        qDebug() << "Контактов:" << ids.size() << "запросов телефонов:" << queries;
+
+        QBENCHMARK {
+            load();
+        }
+    }
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+void BenchStorage::contactSet_data()
+{
+    QTest::addColumn<QString>("query");
+    QTest::addColumn<bool>("arena");
+    QTest::newRow("вся книга, std::vector") << QString() << false;
+    QTest::newRow("вся книга, арена") << QString() << true;
+    QTest::newRow("поиск, std::vector") << QString("а") << false;
+    QTest::newRow("поиск, арена") << QString("а") << true;
+}
+
+// Набор контактов PhoneBook в обычной памяти и в монотонной арене: строки
+// контакта в арене не требуют отдельных выделений, а освобождаются разом
+void BenchStorage::contactSet()
+{
+    QFETCH(QString, query);
+    QFETCH(bool, arena);
+
+    size_t count = 0;
+    auto build = [&]() {
+        if (arena) {
+            std::pmr::monotonic_buffer_resource resource;
+            count = query.isEmpty() ? m_book->getContacts(&resource).size()
+                                    : m_book->findContacts(query, &resource).size();
+        } else {
+            count = query.isEmpty() ? m_book->getContacts().size()
+                                    : m_book->findContacts(query).size();
+        }
+    };
+
+    const long before = g_allocations.load(std::memory_order_relaxed);
+    build();
+    const long allocations = g_allocations.load(std::memory_order_relaxed) - before;
+    QVERIFY(count > 0);
+    qDebug() << "Контактов:" << count << "выделений памяти:" << allocations
+             << "на контакт:" << double(allocations) / double(count);
+
+    QBENCHMARK {
+        build();
+    }
+}
+
+// ContactTableModel::reload: сброс модели и чтение всех страниц книги
+void BenchStorage::tableReload()
+{
+    ContactTableModel model(m_book.get());
+    QBENCHMARK {
+        model.reload();
+        while (model.canFetchMore(QModelIndex())) {
+            model.fetchMore(QModelIndex());
+        }
+    }
+    QCOMPARE(model.rowCount(), kContacts);
+}
+
+// Все ячейки таблицы, как их запрашивает представление: строка ячейки
+// собирается из UTF-8 поля контакта без промежуточных копий
+void BenchStorage::tableData()
+{
+    ContactTableModel model(m_book.get());
+    while (model.canFetchMore(QModelIndex())) {
+        model.fetchMore(QModelIndex());
+    }
+    QCOMPARE(model.rowCount(), kContacts);
+
+    qint64 characters = 0;
+    auto readAll = [&]() {
+        characters = 0;
+        for (int row = 0; row < model.rowCount(); ++row) {
+            for (int column = 0; column < model.columnCount(); ++column) {
+                characters += model.data(model.index(row, column)).toString().size();
+            }
+        }
+    };
+
+    QBENCHMARK {
+        readAll();
+    }
+    QVERIFY(characters > 0);
+}
+
+void BenchStorage::openStorage_data()
+{
+    QTest::addColumn<QString>("format");
+    QTest::newRow("JSON") << QString("json");
+    QTest::newRow("двоичный") << QString("bin");
+}
+
+// Открытие файла книги и обход всех контактов: файл свернут в снимок,
+// журнала нет
+void BenchStorage::openStorage()
+{
+    QFETCH(QString, format);
+    const QString path = m_dir.filePath("load." + format);
+    {
+        std::unique_ptr<IStorage> storage = createStorage(format, path);
+        std::vector<Contact> contacts = makeBook();
+        std::vector<bool> added = storage->addContacts(contacts);
+        QCOMPARE(int(std::count(added.begin(), added.end(), true)), kContacts);
+        if (auto* file = dynamic_cast<FileStorage*>(storage.get())) {
+            QVERIFY(file->compact());
+        } else {
+            QVERIFY(static_cast<BinaryStorage*>(storage.get())->flush());
+        }
+    }
+
+    int loaded = 0;
+    QBENCHMARK {
+        std::unique_ptr<IStorage> storage = createStorage(format, path);
+        loaded = 0;
+        storage->forEachContact([&loaded](const Contact&) {
+            ++loaded;
+            return true;
+        });
+    }
+    QCOMPARE(loaded, kContacts);
+
+    // Память индекса поиска после загрузки; BinaryStorage строит его
+    // при первом поиске
+    std::unique_ptr<IStorage> storage = createStorage(format, path);
+    QVERIFY(!storage->findContacts("а").empty());
+    size_t indexBytes = 0;
+    if (auto* file = dynamic_cast<FileStorage*>(storage.get())) {
+        indexBytes = file->searchIndexMemoryUsage();
+    } else {
+        indexBytes = static_cast<BinaryStorage*>(storage.get())->searchIndexMemoryUsage();
+    }
+    QVERIFY(indexBytes > 0);
+    qDebug() << "Индекс поиска:" << indexBytes / 1024 << "КБ";
+}
+
+void BenchStorage::loadDatabase()
+{
+    std::vector<Contact> contacts;
+    QBENCHMARK {
+        contacts = m_database->getAllContacts();
+    }
+    QCOMPARE(int(contacts.size()), kContacts);
+}
+
+void BenchStorage::buildContacts_data()
+{
+    QTest::addColumn<bool>("validate");
+    QTest::newRow("проверяющие сеттеры") << true;
+    QTest::newRow("fromStorage") << false;
+}
+
+// Сборка контактов из строк хранилища: через проверяющие сеттеры, как
+// загружались записи раньше, и через Contact::fromStorage
+void BenchStorage::buildContacts()
+{
+    QFETCH(bool, validate);
+    const std::vector<Contact> rows = makeBook();
+
+    int built = 0;
+    QBENCHMARK {
+        std::vector<Contact> contacts;
+        contacts.reserve(rows.size());
+        built = 0;
+        for (const Contact& row : rows) {
+            if (validate) {
+                Contact contact;
+                contact.setId(row.getId());
+                bool valid = contact.setLastName(row.getLastName()) &&
+                             contact.setFirstName(row.getFirstName()) &&
+                             contact.setMiddleName(row.getMiddleName()) &&
+                             contact.setBirthDate(row.getBirthDate()) &&
+                             contact.setEmail(row.getEmail());
+                contact.setAddress(row.getAddress());
+                for (const PhoneNumber& phone : row.getPhoneNumbers()) {
+                    contact.addPhoneNumber(PhoneNumber(phone.getNumber(), phone.getType()));
+                }
+                built += valid && contact.getPhoneNumbers().size() == row.getPhoneNumbers().size();
+                contacts.push_back(std::move(contact));
+            } else {
+                Contact contact = Contact::fromStorage(row.getId(), row.getLastName(), row.getFirstName(),
+                                                       row.getMiddleName(), row.getBirthDate(),
+                                                       row.getAddress(), row.getEmail());
+                for (const PhoneNumber& phone : row.getPhoneNumbers()) {
+                    contact.addStoredPhoneNumber(phone.getNumber(), phone.getType());
+                }
+                ++built;
+                contacts.push_back(std::move(contact));
+            }
+        }
+    }
+    // Все строки проходят проверку - сравнивается одна и та же работа
+    QCOMPARE(built, kContacts);
+}
+
+QTEST_GUILESS_MAIN(BenchStorage)
+
+#include "tst_bench_storage.moc"
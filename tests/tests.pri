@@ -0,0 +1,10 @@
+# Общие настройки тестов: исходники приложения подключаются напрямую
+QT += testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+PHONEBOOK_DIR = $$PWD/..
+INCLUDEPATH += $$PHONEBOOK_DIR
+DEPENDPATH += $$PHONEBOOK_DIR
@@ -0,0 +1,8 @@
+# Тесты и замеры производительности.
+# Собираются отдельно от приложения:
+#   qmake tests/tests.pro && make && make check      - проверки
+#   make benchmark                                    - замеры (QBENCHMARK)
+TEMPLATE = subdirs
+SUBDIRS = \
+    auto \
+    benchmarks
@@ -0,0 +1,275 @@
+#include "validation.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+constexpr char32_t kReplacement = 0xFFFD;
+
+bool isAsciiLetter(char32_t c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+}
+
+bool isAsciiDigit(char32_t c) {
+    return c >= '0' && c <= '9';
+}
+
+// Последовательное чтение символов строки
+class Scanner {
+public:
+    explicit Scanner(std::string_view text) : m_text(text) {}
+
+    bool atEnd() const { return m_pos >= m_text.size(); }
+    char32_t peek() const {
+        size_t pos = m_pos;
+        return Validation::decode(m_text, pos);
+    }
+    char32_t next() { return Validation::decode(m_text, m_pos); }
+
+    bool accept(char32_t c) {
+        if (!atEnd() && peek() == c) {
+            next();
+            return true;
+        }
+        return false;
+    }
+
+    // [-\s]?
+    void skipSeparator() {
+        if (!atEnd() && (peek() == '-' || Validation::isSpace(peek()))) {
+            next();
+        }
+    }
+
+    // \d{count}
+    bool digits(int count) {
+        for (int i = 0; i < count; ++i) {
+            if (atEnd() || Validation::digitValue(next()) < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // (\+7|8)
+    bool countryPrefix() {
+        return accept('+') ? accept('7') : accept('8');
+    }
+
+private:
+    std::string_view m_text;
+    size_t m_pos = 0;
+};
+
+} // namespace
+
+char32_t Validation::decode(std::string_view text, size_t& pos) {
+    unsigned char lead = static_cast<unsigned char>(text[pos]);
+    if (lead < 0x80) {
+        ++pos;
+        return lead;
+    }
+
+    size_t length;
+    char32_t c;
+    char32_t min;
+    if ((lead & 0xE0) == 0xC0) {
+        length = 2; c = lead & 0x1F; min = 0x80;
+    } else if ((lead & 0xF0) == 0xE0) {
+        length = 3; c = lead & 0x0F; min = 0x800;
+    } else if ((lead & 0xF8) == 0xF0) {
+        length = 4; c = lead & 0x07; min = 0x10000;
+    } else {
+        ++pos;
+        return kReplacement;
+    }
+    if (pos + length > text.size()) {
+        ++pos;
+        return kReplacement;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        unsigned char next = static_cast<unsigned char>(text[pos + i]);
+        if ((next & 0xC0) != 0x80) {
+            ++pos;
+            return kReplacement;
+        }
+        c = (c << 6) | (next & 0x3F);
+    }
+    // Избыточные формы, суррогаты и значения за пределами Юникода некорректны
+    if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+        ++pos;
+        return kReplacement;
+    }
+    pos += length;
+    return c;
+}
+
+// Управляющие \t..\r, U+0085 и разделители Zs, Zl, Zp
+bool Validation::isSpace(char32_t c) {
+    if (c < 0x80) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+    return c == 0x85 || c == 0xA0 || c == 0x1680 || (c >= 0x2000 && c <= 0x200A) ||
+           c == 0x2028 || c == 0x2029 || c == 0x202F || c == 0x205F || c == 0x3000;
+}
+
+// Десятичные цифры (Nd). В BMP они идут блоками по десять,
+// здесь перечислены нули всех блоков
+int Validation::digitValue(char32_t c) {
+    if (c < 0x80) {
+        return (c >= '0' && c <= '9') ? int(c - '0') : -1;
+    }
+    static const char16_t kZeros[] = {
+        0x0660, 0x06F0, 0x07C0, 0x0966, 0x09E6, 0x0A66, 0x0AE6, 0x0B66, 0x0BE6,
+        0x0C66, 0x0CE6, 0x0D66, 0x0DE6, 0x0E50, 0x0ED0, 0x0F20, 0x1040, 0x1090,
+        0x17E0, 0x1810, 0x1946, 0x19D0, 0x1A80, 0x1A90, 0x1B50, 0x1BB0, 0x1C40,
+        0x1C50, 0xA620, 0xA8D0, 0xA900, 0xA9D0, 0xA9F0, 0xAA50, 0xABF0, 0xFF10
+    };
+    const char16_t* zero = std::upper_bound(std::begin(kZeros), std::end(kZeros), c);
+    if (zero == std::begin(kZeros) || c - *(zero - 1) >= 10) {
+        return -1;
+    }
+    return int(c - *(zero - 1));
+}
+
+std::string_view Validation::trimmed(std::string_view text) {
+    size_t begin = std::string_view::npos;
+    size_t end = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t start = pos;
+        if (!isSpace(decode(text, pos))) {
+            if (begin == std::string_view::npos) {
+                begin = start;
+            }
+            end = pos;
+        }
+    }
+    return begin == std::string_view::npos ? std::string_view() : text.substr(begin, end - begin);
+}
+
+bool Validation::isName(std::string_view text) {
+    if (text.empty()) {
+        return false;
+    }
+
+    Scanner scanner(trimmed(text));
+    if (scanner.atEnd()) {
+        return false;
+    }
+    // Первая буква - заглавная (А-Я - это U+0410..U+042F, без Ё)
+    char32_t first = scanner.next();
+    if (!((first >= 'A' && first <= 'Z') || (first >= 0x0410 && first <= 0x042F))) {
+        return false;
+    }
+    if (scanner.atEnd()) {
+        return false; // нужно хотя бы два символа
+    }
+
+    while (true) {
+        char32_t c = scanner.next();
+        if (scanner.atEnd()) {
+            // Последний - любой, кроме дефиса и пробела. Символ вне BMP
+            // дал бы два символа UTF-16, и первый не прошел бы середину
+            return c != '-' && !isSpace(c) && c <= 0xFFFF;
+        }
+        // Середина: а-я, А-Я (U+0410..U+044F), латиница, цифры, пробелы и дефис
+        bool allowed = isAsciiLetter(c) || isAsciiDigit(c) || c == '-' || isSpace(c) ||
+                       (c >= 0x0410 && c <= 0x044F);
+        if (!allowed) {
+            return false;
+        }
+    }
+}
+
+bool Validation::isEmail(std::string_view text) {
+    if (text.empty()) {
+        return true; // Email может быть пустым
+    }
+
+    // Все классы выражения - ASCII, поэтому дальше проверяем байты
+    std::string_view email = trimmed(text);
+    size_t at = email.find('@');
+    if (at == std::string_view::npos || at == 0) {
+        return false;
+    }
+    for (char c : email.substr(0, at)) {
+        if (!isAsciiLetter(c) && !isAsciiDigit(c) && c != '.' && c != '_' &&
+            c != '%' && c != '+' && c != '-') {
+            return false;
+        }
+    }
+
+    // В домене нет второго @; зона - часть после последней точки:
+    // после любой другой точки остались бы точки, а зона - только буквы
+    std::string_view domain = email.substr(at + 1);
+    for (char c : domain) {
+        if (!isAsciiLetter(c) && !isAsciiDigit(c) && c != '.' && c != '-') {
+            return false;
+        }
+    }
+    size_t dot = domain.rfind('.');
+    if (dot == std::string_view::npos || dot == 0 || domain.size() - dot - 1 < 2) {
+        return false;
+    }
+    for (char c : domain.substr(dot + 1)) {
+        if (!isAsciiLetter(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Validation::isPhoneNumber(std::string_view text) {
+    if (text.empty()) {
+        return false;
+    }
+
+    // Необязательные элементы отличаются от цифр, поэтому выражение
+    // разбирается жадно, без возвратов
+    Scanner scanner(trimmed(text));
+    if (!scanner.countryPrefix()) {
+        return false;
+    }
+    while (!scanner.atEnd() && isSpace(scanner.peek())) {
+        scanner.next();
+    }
+    scanner.accept('(');
+    if (!scanner.digits(3)) {
+        return false;
+    }
+    scanner.accept(')');
+    scanner.skipSeparator();
+    if (!scanner.digits(3)) {
+        return false;
+    }
+    scanner.skipSeparator();
+    if (!scanner.digits(2)) {
+        return false;
+    }
+    scanner.skipSeparator();
+    return scanner.digits(2) && scanner.atEnd();
+}
+
+bool Validation::isStrictPhoneNumber(std::string_view text) {
+    Scanner scanner(trimmed(text));
+    if (!scanner.countryPrefix()) {
+        return false;
+    }
+    if (scanner.accept('(')) {
+        if (!scanner.digits(3) || !scanner.accept(')')) {
+            return false;
+        }
+    } else if (!scanner.digits(3)) {
+        return false;
+    }
+
+    // \d{7} или \d{3}-\d{2}-\d{2}
+    if (!scanner.digits(3)) {
+        return false;
+    }
+    if (scanner.accept('-')) {
+        return scanner.digits(2) && scanner.accept('-') && scanner.digits(2) && scanner.atEnd();
+    }
+    return scanner.digits(4) && scanner.atEnd();
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <string_view>
+
+// Проверки полей контакта без регулярных выражений.
+// Каждая функция - один проход по UTF-8 без выделения памяти, с теми же
+// правилами, что у прежних QRegExp (они приведены у каждой функции).
+// Как и раньше, строка сначала обрезается по краям (QString::trimmed),
+// \s означает QChar::isSpace, \d - QChar::isDigit (десятичные цифры Юникода).
+// Символы вне BMP в QString занимают две единицы UTF-16, ни одна из которых
+// не подходит ни под один класс, поэтому такие строки отвергаются.
+class Validation {
+public:
+    // ^[А-ЯA-Z][а-яА-Яa-zA-Z0-9\s-]*[^-\s]$
+    static bool isName(std::string_view text);
+    // ^[a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,}$
+    static bool isEmail(std::string_view text);
+    // ^(\+7|8)\s*\(?(\d{3})\)?[-\s]?(\d{3})[-\s]?(\d{2})[-\s]?(\d{2})$
+    static bool isPhoneNumber(std::string_view text);
+    // ^(\+7|8)(\(\d{3}\)|\d{3})(\d{7}|\d{3}-\d{2}-\d{2})$
+    static bool isStrictPhoneNumber(std::string_view text);
+
+    // Очередной символ text с позиции pos, pos сдвигается за него.
+    // Некорректный байт, как и в QString::fromUtf8, превращается в U+FFFD
+    static char32_t decode(std::string_view text, size_t& pos);
+    // QChar::isSpace
+    static bool isSpace(char32_t c);
+    // Значение цифры для QChar::isDigit, -1 - не цифра
+    static int digitValue(char32_t c);
+    // Строка без пробельных символов по краям, как после QString::trimmed
+    static std::string_view trimmed(std::string_view text);
+};